@@ -0,0 +1,104 @@
+#include "atrous.h"
+#include "rlgl.h"
+#include <stddef.h>
+
+// Cible intermédiaire en demi-flottants : pas de quantification 8 bits entre les niveaux
+static RenderTexture2D LoadHalfFloatRenderTexture(int width, int height) {
+    RenderTexture2D target = { 0 };
+    target.id = rlLoadFramebuffer();
+    target.texture.id = rlLoadTexture(NULL, width, height, PIXELFORMAT_UNCOMPRESSED_R16G16B16A16, 1);
+    target.texture.width = width;
+    target.texture.height = height;
+    target.texture.mipmaps = 1;
+    target.texture.format = PIXELFORMAT_UNCOMPRESSED_R16G16B16A16;
+
+    rlFramebufferAttach(target.id, target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+    if (!rlFramebufferComplete(target.id)) TraceLog(LOG_WARNING, "ATROUS: Framebuffer incomplet");
+    return target;
+}
+
+void LoadAtrousFilter(AtrousFilter *filter, const char *fileName, int width, int height) {
+    filter->shader = LoadShader(0, fileName);
+    filter->noisyLoc = GetShaderLocation(filter->shader, "renderNoisy");
+    filter->normalsLoc = GetShaderLocation(filter->shader, "renderNormals");
+    filter->materialLoc = GetShaderLocation(filter->shader, "renderMaterial");
+    filter->historyLoc = GetShaderLocation(filter->shader, "renderHistory");
+    filter->reprojectionLoc = GetShaderLocation(filter->shader, "renderReprojection");
+    filter->resolutionLoc = GetShaderLocation(filter->shader, "resolution");
+    filter->stepWidthLoc = GetShaderLocation(filter->shader, "u_stepWidth");
+    filter->colorPhiLoc = GetShaderLocation(filter->shader, "u_colorPhi");
+    filter->normalPhiLoc = GetShaderLocation(filter->shader, "u_normalPhi");
+    filter->depthPhiLoc = GetShaderLocation(filter->shader, "u_depthPhi");
+    filter->historyBlendLoc = GetShaderLocation(filter->shader, "u_historyBlend");
+    filter->renderScaleLoc = GetShaderLocation(filter->shader, "renderScale");
+
+    // Les grands pas passent en premier, sur l'image la plus bruitée : tolérance
+    // sur la couleur large, resserrée à chaque niveau. La tolérance de profondeur
+    // suit l'écart entre taps (surfaces inclinées).
+    filter->levelCount = ATROUS_MAX_LEVELS;
+    for (int i = 0; i < ATROUS_MAX_LEVELS; i++) {
+        filter->levels[i].colorPhi = 0.25f*(float)(1 << i);
+        filter->levels[i].normalPhi = 128.0f;
+        filter->levels[i].depthPhi = 0.02f*(float)(1 << i);
+    }
+
+    // Filtrage bilinéaire : le TAA suréchantillonne la sortie à résolution réduite
+    for (int i = 0; i < 2; i++) {
+        filter->targets[i] = LoadHalfFloatRenderTexture(width, height);
+        SetTextureFilter(filter->targets[i].texture, TEXTURE_FILTER_BILINEAR);
+    }
+}
+
+void UnloadAtrousFilter(AtrousFilter *filter) {
+    UnloadShader(filter->shader);
+    UnloadRenderTexture(filter->targets[0]);
+    UnloadRenderTexture(filter->targets[1]);
+}
+
+Texture2D ApplyAtrousFilter(AtrousFilter *filter, Texture2D input, const GBuffer *gbuffer, Texture2D history,
+                            int width, int height, bool lastLevel) {
+    int current = 0;
+    int lowestLevel = lastLevel ? 0 : 1;
+
+    for (int level = filter->levelCount - 1; level >= lowestLevel; level--) {
+        RenderTexture2D target = filter->targets[current];
+        const AtrousLevel *params = &filter->levels[level];
+        float resolution[2] = { (float)target.texture.width, (float)target.texture.height };
+        float stepWidth = (float)(1 << level);
+        float historyBlend = (level == 0) ? ATROUS_HISTORY_BLEND : 0.0f;
+        float renderScale[2] = { (float)width/resolution[0], (float)height/resolution[1] };
+
+        BeginTextureMode(target);
+            BeginShaderMode(filter->shader);
+                SetShaderValue(filter->shader, filter->resolutionLoc, resolution, SHADER_UNIFORM_VEC2);
+                SetShaderValue(filter->shader, filter->stepWidthLoc, &stepWidth, SHADER_UNIFORM_FLOAT);
+                SetShaderValue(filter->shader, filter->colorPhiLoc, &params->colorPhi, SHADER_UNIFORM_FLOAT);
+                SetShaderValue(filter->shader, filter->normalPhiLoc, &params->normalPhi, SHADER_UNIFORM_FLOAT);
+                SetShaderValue(filter->shader, filter->depthPhiLoc, &params->depthPhi, SHADER_UNIFORM_FLOAT);
+                SetShaderValue(filter->shader, filter->historyBlendLoc, &historyBlend, SHADER_UNIFORM_FLOAT);
+                SetShaderValue(filter->shader, filter->renderScaleLoc, renderScale, SHADER_UNIFORM_VEC2);
+
+                // L'image d'entrée est la texture du quad (unité 0) : les unités 1 à 4
+                // de raylib restent libres pour le G-buffer et l'historique
+                int noisyUnit = 0;
+                SetShaderValue(filter->shader, filter->noisyLoc, &noisyUnit, SHADER_UNIFORM_SAMPLER2D);
+                SetShaderValueTexture(filter->shader, filter->normalsLoc, gbuffer->normals);
+                SetShaderValueTexture(filter->shader, filter->materialLoc, gbuffer->material);
+                SetShaderValueTexture(filter->shader, filter->historyLoc, history);
+                SetShaderValueTexture(filter->shader, filter->reprojectionLoc, gbuffer->reprojection);
+
+                // Quad sur la partie rendue (l'image source est retournée comme dans les
+                // autres passes) : le coin bas-gauche GL, où raytest.fs a écrit
+                DrawTexturePro(input,
+                               (Rectangle){ 0, 0, (float)width, -(float)height },
+                               (Rectangle){ 0, resolution[1] - (float)height, (float)width, (float)height },
+                               (Vector2){ 0, 0 }, 0.0f, WHITE);
+            EndShaderMode();
+        EndTextureMode();
+
+        input = target.texture;
+        current = 1 - current;
+    }
+
+    return input;
+}
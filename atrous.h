@@ -0,0 +1,52 @@
+#ifndef ATROUS_H
+#define ATROUS_H
+
+#include "raylib.h"
+#include "gbuffer.h"
+
+#define ATROUS_MAX_LEVELS 5         // Pas 1, 2, 4, 8, 16
+#define ATROUS_HISTORY_BLEND 0.1f   // Mélange avec la frame précédente au dernier niveau
+
+// Paramètres d'un niveau (pas de 2^niveau pixels)
+typedef struct {
+    float colorPhi;     // Tolérance sur la couleur
+    float normalPhi;    // Exposant sur dot(n, n')
+    float depthPhi;     // Écart de profondeur toléré, relatif à la profondeur
+} AtrousLevel;
+
+// Chaîne de débruitage À-Trous (denoise.fs) : chaque niveau est un filtre 5x5
+// dont les taps sont espacés de 2^niveau pixels, pour un rayon total de 62
+// pixels à coût constant par niveau. Les niveaux sont appliqués du plus grand
+// pas au pas 1 ; le dernier peut être confié à la passe fusionnée
+// (denoise_taa.comp). Les deux cibles RGBA16F sont utilisées en alternance.
+typedef struct {
+    Shader shader;
+    int noisyLoc;
+    int normalsLoc;
+    int materialLoc;
+    int historyLoc;
+    int reprojectionLoc;
+    int resolutionLoc;
+    int stepWidthLoc;
+    int colorPhiLoc;
+    int normalPhiLoc;
+    int depthPhiLoc;
+    int historyBlendLoc;
+    int renderScaleLoc;
+
+    int levelCount;                         // 1 à ATROUS_MAX_LEVELS
+    AtrousLevel levels[ATROUS_MAX_LEVELS];  // Réglables à l'exécution
+    RenderTexture2D targets[2];
+} AtrousFilter;
+
+void LoadAtrousFilter(AtrousFilter *filter, const char *fileName, int width, int height);
+void UnloadAtrousFilter(AtrousFilter *filter);
+
+// Applique les niveaux levelCount-1 ... 1, puis le niveau 0 si lastLevel est vrai.
+// Seuls les width x height premiers pixels sont filtrés (résolution dynamique),
+// les textures gardant leur taille. Retourne la texture du dernier niveau
+// exécuté (input si aucun).
+Texture2D ApplyAtrousFilter(AtrousFilter *filter, Texture2D input, const GBuffer *gbuffer, Texture2D history,
+                            int width, int height, bool lastLevel);
+
+#endif // ATROUS_H
@@ -0,0 +1,157 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "blue_noise.h"
+#include <math.h>
+#include <vector>
+#include <thread>
+
+#define BLUE_NOISE_PIXELS (BLUE_NOISE_SIZE*BLUE_NOISE_SIZE)
+#define BLUE_NOISE_INITIAL_DENSITY 10   // Pourcentage de points du motif initial
+
+// Générateur pseudo-aléatoire simple (xorshift), pour un motif reproductible
+static unsigned int NextRandom(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Énergie de chaque pixel : somme des gaussiennes (toriques) centrées sur les
+// points du motif. Les mises à jour ajoutent ou retirent un seul noyau.
+typedef struct {
+    std::vector<float> kernel;      // Gaussienne torique centrée en (0, 0)
+    std::vector<float> energy;
+    std::vector<unsigned char> points;
+} VoidAndCluster;
+
+static void TogglePoint(VoidAndCluster *vc, int index, bool set) {
+    int px = index % BLUE_NOISE_SIZE;
+    int py = index / BLUE_NOISE_SIZE;
+    float sign = set ? 1.0f : -1.0f;
+    vc->points[index] = set ? 1 : 0;
+
+    for (int y = 0; y < BLUE_NOISE_SIZE; y++) {
+        int ky = (y - py + BLUE_NOISE_SIZE) % BLUE_NOISE_SIZE;
+        for (int x = 0; x < BLUE_NOISE_SIZE; x++) {
+            int kx = (x - px + BLUE_NOISE_SIZE) % BLUE_NOISE_SIZE;
+            vc->energy[y*BLUE_NOISE_SIZE + x] += sign*vc->kernel[ky*BLUE_NOISE_SIZE + kx];
+        }
+    }
+}
+
+// Amas le plus serré (point d'énergie maximale) ou plus grand vide (pixel libre
+// d'énergie minimale)
+static int FindExtremum(const VoidAndCluster *vc, bool tightestCluster) {
+    int best = -1;
+    for (int i = 0; i < BLUE_NOISE_PIXELS; i++) {
+        if ((vc->points[i] != 0) != tightestCluster) continue;
+        if ((best < 0) ||
+            (tightestCluster && (vc->energy[i] > vc->energy[best])) ||
+            (!tightestCluster && (vc->energy[i] < vc->energy[best]))) best = i;
+    }
+    return best;
+}
+
+// Rang (0 .. BLUE_NOISE_PIXELS-1) de chaque pixel dans l'ordre d'insertion
+static void GenerateBlueNoiseRanks(const std::vector<float> &kernel, unsigned int seed, std::vector<int> &ranks) {
+    VoidAndCluster vc;
+    vc.kernel = kernel;
+    vc.energy.assign(BLUE_NOISE_PIXELS, 0.0f);
+    vc.points.assign(BLUE_NOISE_PIXELS, 0);
+    ranks.assign(BLUE_NOISE_PIXELS, 0);
+
+    // Motif initial aléatoire, puis redistribution : le point du plus gros amas
+    // est déplacé vers le plus grand vide jusqu'à ce que ce soit le même pixel
+    unsigned int state = (seed != 0) ? seed : 1u;
+    int initialCount = BLUE_NOISE_PIXELS*BLUE_NOISE_INITIAL_DENSITY/100;
+    for (int placed = 0; placed < initialCount;) {
+        int i = (int)(NextRandom(&state) % BLUE_NOISE_PIXELS);
+        if (vc.points[i] != 0) continue;
+        TogglePoint(&vc, i, true);
+        placed++;
+    }
+    for (;;) {
+        int cluster = FindExtremum(&vc, true);
+        TogglePoint(&vc, cluster, false);
+        int hole = FindExtremum(&vc, false);
+        TogglePoint(&vc, hole, true);
+        if (hole == cluster) break;
+    }
+    std::vector<unsigned char> initialPoints = vc.points;
+    std::vector<float> initialEnergy = vc.energy;
+
+    // Phase 1 : rangs décroissants en retirant les amas du motif initial
+    for (int rank = initialCount - 1; rank >= 0; rank--) {
+        int cluster = FindExtremum(&vc, true);
+        TogglePoint(&vc, cluster, false);
+        ranks[cluster] = rank;
+    }
+
+    // Phases 2 et 3 : rangs croissants en comblant les vides. Au-delà de la
+    // moitié, le plus gros amas de pixels libres est aussi le pixel libre
+    // d'énergie minimale (la somme des deux énergies est constante) : même règle.
+    vc.points = initialPoints;
+    vc.energy = initialEnergy;
+    for (int rank = initialCount; rank < BLUE_NOISE_PIXELS; rank++) {
+        int hole = FindExtremum(&vc, false);
+        TogglePoint(&vc, hole, true);
+        ranks[hole] = rank;
+    }
+}
+
+BlueNoise LoadBlueNoise(unsigned int seed) {
+    BlueNoise noise = { 0 };
+    double start = GetTime();
+
+    std::vector<float> kernel(BLUE_NOISE_PIXELS);
+    for (int y = 0; y < BLUE_NOISE_SIZE; y++) {
+        for (int x = 0; x < BLUE_NOISE_SIZE; x++) {
+            // Distance torique au centre (0, 0)
+            float dx = (float)((x <= BLUE_NOISE_SIZE/2) ? x : BLUE_NOISE_SIZE - x);
+            float dy = (float)((y <= BLUE_NOISE_SIZE/2) ? y : BLUE_NOISE_SIZE - y);
+            kernel[y*BLUE_NOISE_SIZE + x] = expf(-(dx*dx + dy*dy)/(2.0f*BLUE_NOISE_SIGMA*BLUE_NOISE_SIGMA));
+        }
+    }
+
+    // Un motif indépendant par canal, chacun dans son thread (O(n²) par canal)
+    std::vector<int> ranks[4];
+    std::thread workers[4];
+    for (int channel = 0; channel < 4; channel++) {
+        workers[channel] = std::thread(GenerateBlueNoiseRanks, std::cref(kernel), seed*4u + (unsigned int)channel + 1u, std::ref(ranks[channel]));
+    }
+    for (int channel = 0; channel < 4; channel++) workers[channel].join();
+
+    std::vector<unsigned char> pixels(BLUE_NOISE_PIXELS*4);
+    for (int channel = 0; channel < 4; channel++) {
+        for (int i = 0; i < BLUE_NOISE_PIXELS; i++) pixels[i*4 + channel] = (unsigned char)(ranks[channel][i]*256/BLUE_NOISE_PIXELS);
+    }
+
+    Image image = { 0 };
+    image.data = pixels.data();
+    image.width = BLUE_NOISE_SIZE;
+    image.height = BLUE_NOISE_SIZE;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    noise.texture = LoadTextureFromImage(image);
+    SetTextureWrap(noise.texture, TEXTURE_WRAP_REPEAT);
+    SetTextureFilter(noise.texture, TEXTURE_FILTER_POINT);
+
+    // Liée une fois pour toutes sur son unité réservée
+    glActiveTexture(GL_TEXTURE0 + BLUE_NOISE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, noise.texture.id);
+    glActiveTexture(GL_TEXTURE0);
+
+    noise.generationMs = (float)((GetTime() - start)*1000.0);
+    return noise;
+}
+
+void UnloadBlueNoise(BlueNoise *noise) {
+    UnloadTexture(noise->texture);
+}
+
+void BindBlueNoiseSampler(Shader shader) {
+    int unit = BLUE_NOISE_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "blueNoise"), &unit, SHADER_UNIFORM_INT);
+}
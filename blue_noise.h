@@ -0,0 +1,26 @@
+#ifndef BLUE_NOISE_H
+#define BLUE_NOISE_H
+
+#include "raylib.h"
+
+#define BLUE_NOISE_SIZE 64              // Tuile carrée, puissance de deux (répétée dans raytest.fs)
+#define BLUE_NOISE_TEXTURE_UNIT 7       // Unité réservée (raylib n'utilise que les premières)
+#define BLUE_NOISE_SIGMA 1.5f           // Écart-type du noyau d'énergie (void-and-cluster)
+
+// Texture de bruit bleu à 4 canaux indépendants, générée sur CPU par
+// void-and-cluster (Ulichney) au chargement. raytest.fs s'en sert pour la
+// rotation par pixel des séquences de Sobol : l'erreur d'un pixel à l'autre
+// est répartie en hautes fréquences, que le débruitage élimine mieux qu'un
+// bruit blanc.
+typedef struct {
+    Texture2D texture;
+    float generationMs;     // Durée de la génération (CPU)
+} BlueNoise;
+
+BlueNoise LoadBlueNoise(unsigned int seed);
+void UnloadBlueNoise(BlueNoise *noise);
+
+// Liaison du sampler blueNoise d'un shader à son unité de texture
+void BindBlueNoiseSampler(Shader shader);
+
+#endif // BLUE_NOISE_H
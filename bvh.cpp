@@ -0,0 +1,450 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "bvh.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include <atomic>
+
+#define MAT_EAU 6
+
+// Reconstruction d'arrière-plan : le thread travaille sur une copie des
+// primitives et construit un arbre complet, adopté par UpdateBvh une fois prêt
+struct BvhRebuild {
+    std::thread thread;
+    std::atomic<bool> done;
+    SceneStorage snapshot;          // Seuls spheres et blocks sont renseignés
+    Bvh result;                     // Sans texture buffers
+    unsigned int layoutVersion;
+};
+
+static Aabb EmptyAabb(void) {
+    Aabb box = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+    return box;
+}
+
+static void GrowAabb(Aabb *box, const Aabb *other) {
+    box->min.x = fminf(box->min.x, other->min.x);
+    box->min.y = fminf(box->min.y, other->min.y);
+    box->min.z = fminf(box->min.z, other->min.z);
+    box->max.x = fmaxf(box->max.x, other->max.x);
+    box->max.y = fmaxf(box->max.y, other->max.y);
+    box->max.z = fmaxf(box->max.z, other->max.z);
+}
+
+static float AabbArea(Vector3 min, Vector3 max) {
+    Vector3 e = { max.x - min.x, max.y - min.y, max.z - min.z };
+    if (e.x < 0.0f || e.y < 0.0f || e.z < 0.0f) return 0.0f;
+    return 2.0f*(e.x*e.y + e.y*e.z + e.z*e.x);
+}
+
+static float Component(Vector3 v, int axis) {
+    return (axis == 0) ? v.x : (axis == 1) ? v.y : v.z;
+}
+
+// Boîte englobante d'une primitive : identifiants [0, sphères) puis blocs
+static Aabb PrimitiveBounds(const SceneStorage *storage, int id) {
+    Aabb box;
+    int sphereCount = (int)storage->spheres.size();
+    if (id < sphereCount) {
+        const Sphere *s = &storage->spheres[id].sphere;
+        box.min = (Vector3){ s->position.x - s->radius, s->position.y - s->radius, s->position.z - s->radius };
+        box.max = (Vector3){ s->position.x + s->radius, s->position.y + s->radius, s->position.z + s->radius };
+    } else {
+        // Les blocs sont centrés sur leur position (comme dans trace())
+        const BlockRecord *b = &storage->blocks[id - sphereCount];
+        Vector3 half = { b->size.v.x*0.5f, b->size.v.y*0.5f, b->size.v.z*0.5f };
+        box.min = (Vector3){ b->position.v.x - half.x, b->position.v.y - half.y, b->position.v.z - half.z };
+        box.max = (Vector3){ b->position.v.x + half.x, b->position.v.y + half.y, b->position.v.z + half.z };
+        if (b->material.type == MAT_EAU) {
+            box.min.y -= BVH_WATER_MARGIN;
+            box.max.y += BVH_WATER_MARGIN;
+        }
+    }
+    return box;
+}
+
+static int EncodePrimRef(const SceneStorage *storage, int id) {
+    int sphereCount = (int)storage->spheres.size();
+    if (id < sphereCount) return id << BVH_PRIM_SHIFT;
+    int blockIndex = id - sphereCount;
+    int ref = (blockIndex << BVH_PRIM_SHIFT) | BVH_PRIM_BLOCK;
+    if (storage->blocks[blockIndex].material.type == MAT_EAU) ref |= BVH_PRIM_NO_SHADOW;
+    return ref;
+}
+
+static void UpdateNodeBounds(Bvh *bvh, int nodeIndex) {
+    BvhNode *node = &bvh->nodes[nodeIndex];
+    Aabb box = EmptyAabb();
+    for (int i = 0; i < node->count; i++) GrowAabb(&box, &bvh->primBounds[bvh->primIds[node->leftFirst + i]]);
+    node->min = box.min;
+    node->max = box.max;
+}
+
+// Recherche du meilleur plan de coupe (SAH par classes sur les centroïdes).
+// Retourne le coût de la coupe, ou FLT_MAX si aucune coupe n'est possible.
+static float FindBestSplit(const Bvh *bvh, const BvhNode *node, int *bestAxis, int *bestBin,
+                           float *bestMin, float *bestScale) {
+    float bestCost = FLT_MAX;
+    *bestAxis = -1;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float cmin = FLT_MAX, cmax = -FLT_MAX;
+        for (int i = 0; i < node->count; i++) {
+            float c = Component(bvh->centroids[bvh->primIds[node->leftFirst + i]], axis);
+            cmin = fminf(cmin, c);
+            cmax = fmaxf(cmax, c);
+        }
+        if (cmax <= cmin) continue;
+
+        Aabb binBounds[BVH_BIN_COUNT];
+        int binCount[BVH_BIN_COUNT];
+        for (int b = 0; b < BVH_BIN_COUNT; b++) {
+            binBounds[b] = EmptyAabb();
+            binCount[b] = 0;
+        }
+
+        float scale = (float)BVH_BIN_COUNT/(cmax - cmin);
+        for (int i = 0; i < node->count; i++) {
+            int id = bvh->primIds[node->leftFirst + i];
+            int b = (int)((Component(bvh->centroids[id], axis) - cmin)*scale);
+            if (b > BVH_BIN_COUNT - 1) b = BVH_BIN_COUNT - 1;
+            binCount[b]++;
+            GrowAabb(&binBounds[b], &bvh->primBounds[id]);
+        }
+
+        // Balayage gauche -> droite puis droite -> gauche des surfaces cumulées
+        float leftArea[BVH_BIN_COUNT - 1], rightArea[BVH_BIN_COUNT - 1];
+        int leftCount[BVH_BIN_COUNT - 1], rightCount[BVH_BIN_COUNT - 1];
+        Aabb leftBox = EmptyAabb(), rightBox = EmptyAabb();
+        int leftSum = 0, rightSum = 0;
+        for (int b = 0; b < BVH_BIN_COUNT - 1; b++) {
+            leftSum += binCount[b];
+            leftCount[b] = leftSum;
+            GrowAabb(&leftBox, &binBounds[b]);
+            leftArea[b] = AabbArea(leftBox.min, leftBox.max);
+
+            rightSum += binCount[BVH_BIN_COUNT - 1 - b];
+            rightCount[BVH_BIN_COUNT - 2 - b] = rightSum;
+            GrowAabb(&rightBox, &binBounds[BVH_BIN_COUNT - 1 - b]);
+            rightArea[BVH_BIN_COUNT - 2 - b] = AabbArea(rightBox.min, rightBox.max);
+        }
+
+        for (int b = 0; b < BVH_BIN_COUNT - 1; b++) {
+            if (leftCount[b] == 0 || rightCount[b] == 0) continue;
+            float cost = leftCount[b]*leftArea[b] + rightCount[b]*rightArea[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                *bestAxis = axis;
+                *bestBin = b;
+                *bestMin = cmin;
+                *bestScale = scale;
+            }
+        }
+    }
+
+    return bestCost;
+}
+
+static void Subdivide(Bvh *bvh, int nodeIndex, int depth) {
+    BvhNode *node = &bvh->nodes[nodeIndex];
+    if (node->count <= 1 || depth >= BVH_MAX_DEPTH - 1) return;
+
+    int axis, splitBin;
+    float cmin, scale;
+    float splitCost = FindBestSplit(bvh, node, &axis, &splitBin, &cmin, &scale);
+    if (axis < 0) return;   // Centroïdes confondus : aucune coupe possible
+
+    float leafCost = node->count*AabbArea(node->min, node->max);
+    if (splitCost >= leafCost && node->count <= BVH_MAX_LEAF_SIZE) return;
+
+    // Partition en place des références selon la classe de leur centroïde
+    int i = node->leftFirst;
+    int j = i + node->count - 1;
+    while (i <= j) {
+        int b = (int)((Component(bvh->centroids[bvh->primIds[i]], axis) - cmin)*scale);
+        if (b > BVH_BIN_COUNT - 1) b = BVH_BIN_COUNT - 1;
+        if (b <= splitBin) i++;
+        else {
+            int tmp = bvh->primIds[i];
+            bvh->primIds[i] = bvh->primIds[j];
+            bvh->primIds[j] = tmp;
+            j--;
+        }
+    }
+
+    int leftCount = i - node->leftFirst;
+    if (leftCount == 0 || leftCount == node->count) return;
+
+    int leftIndex = bvh->nodeCount;
+    bvh->nodeCount += 2;
+
+    BvhNode *left = &bvh->nodes[leftIndex];
+    BvhNode *right = &bvh->nodes[leftIndex + 1];
+    left->leftFirst = node->leftFirst;
+    left->count = leftCount;
+    right->leftFirst = i;
+    right->count = node->count - leftCount;
+    node->leftFirst = leftIndex;
+    node->count = 0;
+    bvh->parents[leftIndex] = nodeIndex;
+    bvh->parents[leftIndex + 1] = nodeIndex;
+
+    UpdateNodeBounds(bvh, leftIndex);
+    UpdateNodeBounds(bvh, leftIndex + 1);
+    Subdivide(bvh, leftIndex, depth + 1);
+    Subdivide(bvh, leftIndex + 1, depth + 1);
+}
+
+static float NodeSahWeight(const BvhNode *node) {
+    return (node->count > 0) ? (float)node->count : 1.0f;
+}
+
+// Coût de traversée et d'intersection unitaires, non normalisé
+static float ComputeSahSum(const Bvh *bvh) {
+    float sum = 0.0f;
+    for (int i = 0; i < bvh->nodeCount; i++) {
+        const BvhNode *node = &bvh->nodes[i];
+        sum += NodeSahWeight(node)*AabbArea(node->min, node->max);
+    }
+    return sum;
+}
+
+// Construction de l'arbre seul (sans GL, utilisable depuis un autre thread)
+static void BuildBvhTree(Bvh *bvh, const SceneStorage *storage) {
+    double start = GetTime();
+
+    int primCount = (int)(storage->spheres.size() + storage->blocks.size());
+    bvh->primIds.resize(primCount);
+    bvh->primBounds.resize(primCount);
+    bvh->centroids.resize(primCount);
+    for (int id = 0; id < primCount; id++) {
+        Aabb box = PrimitiveBounds(storage, id);
+        bvh->primIds[id] = id;
+        bvh->primBounds[id] = box;
+        bvh->centroids[id] = (Vector3){ (box.min.x + box.max.x)*0.5f, (box.min.y + box.max.y)*0.5f, (box.min.z + box.max.z)*0.5f };
+    }
+
+    // Un arbre binaire à N feuilles au plus a 2N - 1 nœuds
+    int maxNodes = (primCount > 0) ? 2*primCount - 1 : 1;
+    bvh->nodes.resize(maxNodes);
+    bvh->parents.resize(maxNodes);
+    bvh->nodeCount = 0;
+    if (primCount > 0) {
+        BvhNode *root = &bvh->nodes[0];
+        root->leftFirst = 0;
+        root->count = primCount;
+        bvh->parents[0] = -1;
+        bvh->nodeCount = 1;
+        UpdateNodeBounds(bvh, 0);
+        Subdivide(bvh, 0, 0);
+    }
+    bvh->nodes.resize((bvh->nodeCount > 0) ? bvh->nodeCount : 1);
+    bvh->parents.resize(bvh->nodes.size());
+
+    bvh->primRefs.resize(primCount);
+    for (int i = 0; i < primCount; i++) bvh->primRefs[i] = EncodePrimRef(storage, bvh->primIds[i]);
+
+    bvh->primLeaf.resize(primCount);
+    for (int i = 0; i < bvh->nodeCount; i++) {
+        const BvhNode *node = &bvh->nodes[i];
+        for (int k = 0; k < node->count; k++) bvh->primLeaf[bvh->primIds[node->leftFirst + k]] = i;
+    }
+
+    bvh->sahSum = ComputeSahSum(bvh);
+    bvh->builtSahCost = GetBvhSahCost(bvh);
+    bvh->buildMs = (float)((GetTime() - start)*1000.0);
+}
+
+// Après une (re)construction, l'arbre entier sera renvoyé
+static void ResetBvhUploads(Bvh *bvh) {
+    bvh->refitNodes.clear();
+    bvh->refitQueued.assign(bvh->nodes.size(), 0);
+    InvalidateSceneTextureBuffer(&bvh->nodeBuffer);
+    InvalidateSceneTextureBuffer(&bvh->primBuffer);
+}
+
+static void QueueNodeUpload(Bvh *bvh, int nodeIndex) {
+    if (bvh->refitQueued[nodeIndex]) return;
+    bvh->refitQueued[nodeIndex] = 1;
+    bvh->refitNodes.push_back(nodeIndex);
+}
+
+// Recalcule la boîte d'un nœud à partir de ses fils (ou de ses primitives).
+// Retourne faux si elle n'a pas changé.
+static bool RefitNode(Bvh *bvh, int nodeIndex) {
+    BvhNode *node = &bvh->nodes[nodeIndex];
+    Vector3 oldMin = node->min;
+    Vector3 oldMax = node->max;
+
+    if (node->count > 0) {
+        UpdateNodeBounds(bvh, nodeIndex);
+    } else {
+        const BvhNode *left = &bvh->nodes[node->leftFirst];
+        const BvhNode *right = &bvh->nodes[node->leftFirst + 1];
+        node->min = (Vector3){ fminf(left->min.x, right->min.x), fminf(left->min.y, right->min.y), fminf(left->min.z, right->min.z) };
+        node->max = (Vector3){ fmaxf(left->max.x, right->max.x), fmaxf(left->max.y, right->max.y), fmaxf(left->max.z, right->max.z) };
+    }
+
+    if (memcmp(&oldMin, &node->min, sizeof(Vector3)) == 0 && memcmp(&oldMax, &node->max, sizeof(Vector3)) == 0) return false;
+    bvh->sahSum += NodeSahWeight(node)*(AabbArea(node->min, node->max) - AabbArea(oldMin, oldMax));
+    return true;
+}
+
+// Refit d'une primitive déplacée : sa feuille puis les ancêtres, en s'arrêtant
+// dès qu'une boîte ne change plus
+static void RefitPrimitive(Bvh *bvh, const SceneStorage *storage, int id) {
+    Aabb box = PrimitiveBounds(storage, id);
+    if (memcmp(&box, &bvh->primBounds[id], sizeof(Aabb)) == 0) return;
+    bvh->primBounds[id] = box;
+    bvh->centroids[id] = (Vector3){ (box.min.x + box.max.x)*0.5f, (box.min.y + box.max.y)*0.5f, (box.min.z + box.max.z)*0.5f };
+
+    for (int node = bvh->primLeaf[id]; node >= 0; node = bvh->parents[node]) {
+        if (!RefitNode(bvh, node)) break;
+        QueueNodeUpload(bvh, node);
+        bvh->refitCount++;
+    }
+}
+
+static void RunBvhRebuild(BvhRebuild *job) {
+    BuildBvhTree(&job->result, &job->snapshot);
+    job->done = true;
+}
+
+static void StartBvhRebuild(Bvh *bvh, const SceneStorage *storage) {
+    BvhRebuild *job = new BvhRebuild();
+    job->snapshot.spheres = storage->spheres;
+    job->snapshot.blocks = storage->blocks;
+    job->result.nodeCount = 0;
+    job->result.rebuild = NULL;
+    job->layoutVersion = storage->layoutVersion;
+    job->done = false;
+    job->thread = std::thread(RunBvhRebuild, job);
+    bvh->rebuild = job;
+}
+
+// Remplace l'arbre par celui reconstruit en arrière-plan. Les primitives ayant pu
+// bouger depuis la copie, toutes les boîtes sont recalculées (une fois par
+// reconstruction) ; les fils ayant un index supérieur à leur parent, un
+// parcours à rebours suffit.
+static void AdoptBvhRebuild(Bvh *bvh, const SceneStorage *storage) {
+    Bvh *result = &bvh->rebuild->result;
+    bvh->nodes.swap(result->nodes);
+    bvh->parents.swap(result->parents);
+    bvh->primIds.swap(result->primIds);
+    bvh->primRefs.swap(result->primRefs);
+    bvh->primLeaf.swap(result->primLeaf);
+    bvh->nodeCount = result->nodeCount;
+    bvh->buildMs = result->buildMs;
+
+    int primCount = (int)bvh->primLeaf.size();
+    for (int id = 0; id < primCount; id++) {
+        Aabb box = PrimitiveBounds(storage, id);
+        bvh->primBounds[id] = box;
+        bvh->centroids[id] = (Vector3){ (box.min.x + box.max.x)*0.5f, (box.min.y + box.max.y)*0.5f, (box.min.z + box.max.z)*0.5f };
+    }
+    for (int i = bvh->nodeCount - 1; i >= 0; i--) RefitNode(bvh, i);
+
+    bvh->sahSum = ComputeSahSum(bvh);
+    bvh->builtSahCost = GetBvhSahCost(bvh);
+    ResetBvhUploads(bvh);
+    bvh->rebuildCount++;
+}
+
+static void FinishBvhRebuild(Bvh *bvh) {
+    bvh->rebuild->thread.join();
+    delete bvh->rebuild;
+    bvh->rebuild = NULL;
+}
+
+void InitBvh(Bvh *bvh) {
+    LoadSceneTextureBuffer(&bvh->nodeBuffer, GL_RGBA32F, BVH_NODE_TEXTURE_UNIT);
+    LoadSceneTextureBuffer(&bvh->primBuffer, GL_R32I, BVH_PRIM_TEXTURE_UNIT);
+    bvh->nodeCount = 0;
+    bvh->sahSum = 0.0f;
+    bvh->builtSahCost = 0.0f;
+    bvh->layoutVersion = 0;
+    bvh->rebuild = NULL;
+    bvh->buildMs = 0.0f;
+    bvh->refitCount = 0;
+    bvh->rebuildCount = 0;
+}
+
+void UnloadBvh(Bvh *bvh) {
+    if (bvh->rebuild != NULL) FinishBvhRebuild(bvh);
+    UnloadSceneTextureBuffer(&bvh->nodeBuffer);
+    UnloadSceneTextureBuffer(&bvh->primBuffer);
+    bvh->nodes.clear();
+    bvh->parents.clear();
+    bvh->primIds.clear();
+    bvh->primRefs.clear();
+    bvh->primLeaf.clear();
+}
+
+void BuildBvh(Bvh *bvh, const SceneStorage *storage) {
+    BuildBvhTree(bvh, storage);
+    bvh->layoutVersion = storage->layoutVersion;
+    ResetBvhUploads(bvh);
+}
+
+void UpdateBvh(Bvh *bvh, SceneStorage *storage) {
+    bvh->refitCount = 0;
+
+    // Reconstruction d'arrière-plan terminée : adoptée si la scène a gardé les mêmes primitives
+    if (bvh->rebuild != NULL && bvh->rebuild->done) {
+        if (bvh->rebuild->layoutVersion == storage->layoutVersion && bvh->layoutVersion == storage->layoutVersion) {
+            AdoptBvhRebuild(bvh, storage);
+        }
+        FinishBvhRebuild(bvh);
+    }
+
+    if (bvh->layoutVersion != storage->layoutVersion || bvh->primLeaf.size() != storage->spheres.size() + storage->blocks.size()) {
+        // Primitives ajoutées ou retirées : les identifiants ont changé
+        BuildBvh(bvh, storage);
+    } else {
+        int sphereCount = (int)storage->spheres.size();
+        for (int i = 0; i < (int)storage->movedSpheres.size(); i++) RefitPrimitive(bvh, storage, storage->movedSpheres[i]);
+        for (int i = 0; i < (int)storage->movedBlocks.size(); i++) RefitPrimitive(bvh, storage, sphereCount + storage->movedBlocks[i]);
+
+        if (bvh->rebuild == NULL && GetBvhSahCost(bvh) > bvh->builtSahCost*BVH_REBUILD_SAH_RATIO) {
+            StartBvhRebuild(bvh, storage);
+        }
+    }
+
+    storage->movedSpheres.clear();
+    storage->movedBlocks.clear();
+}
+
+float GetBvhSahCost(const Bvh *bvh) {
+    if (bvh->nodeCount == 0) return 0.0f;
+    float rootArea = AabbArea(bvh->nodes[0].min, bvh->nodes[0].max);
+    if (rootArea <= 0.0f) return 0.0f;
+    return bvh->sahSum/rootArea;
+}
+
+unsigned int UploadBvh(Bvh *bvh) {
+    unsigned int uploaded = 0;
+
+    // Peu de nœuds modifiés : envoi nœud par nœud (ils sont dispersés entre la
+    // racine et les feuilles), sinon une seule plage
+    int refitCount = (int)bvh->refitNodes.size();
+    if (refitCount > 0 && refitCount <= BVH_MAX_SCATTERED_UPLOADS && !bvh->nodeBuffer.reallocate) {
+        uploaded += UploadSceneTextureBufferRecords(&bvh->nodeBuffer, bvh->nodes.data(), bvh->refitNodes.data(), refitCount, sizeof(BvhNode));
+    } else {
+        for (int i = 0; i < refitCount; i++) MarkSceneTextureBufferDirty(&bvh->nodeBuffer, bvh->refitNodes[i]);
+        uploaded += UploadSceneTextureBuffer(&bvh->nodeBuffer, bvh->nodes.data(), (unsigned int)bvh->nodeCount, sizeof(BvhNode));
+    }
+    for (int i = 0; i < refitCount; i++) bvh->refitQueued[bvh->refitNodes[i]] = 0;
+    bvh->refitNodes.clear();
+
+    uploaded += UploadSceneTextureBuffer(&bvh->primBuffer, bvh->primRefs.data(), (unsigned int)bvh->primRefs.size(), sizeof(int));
+    return uploaded;
+}
+
+void BindBvhSamplers(Shader shader) {
+    int nodeUnit = BVH_NODE_TEXTURE_UNIT;
+    int primUnit = BVH_PRIM_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "bvhNodes"), &nodeUnit, SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "bvhPrims"), &primUnit, SHADER_UNIFORM_INT);
+}
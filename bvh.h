@@ -0,0 +1,103 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "raylib.h"
+#include "scene_storage.h"
+#include <vector>
+
+// Unités de texture réservées aux buffers du BVH
+#define BVH_NODE_TEXTURE_UNIT 10
+#define BVH_PRIM_TEXTURE_UNIT 11
+
+#define BVH_BIN_COUNT 12        // Nombre de classes pour l'évaluation du SAH
+#define BVH_MAX_LEAF_SIZE 4     // Au-delà, une feuille est découpée même si le SAH ne l'exige pas
+#define BVH_MAX_DEPTH 32        // Doit être <= BVH_STACK_SIZE dans raytest.fs
+
+// Reconstruction en arrière-plan quand le coût SAH après refit dépasse ce
+// multiple du coût obtenu à la dernière construction
+#define BVH_REBUILD_SAH_RATIO 1.5f
+// Au-delà de ce nombre de nœuds modifiés, la plage entière est renvoyée d'un bloc
+#define BVH_MAX_SCATTERED_UPLOADS 64
+
+// Marge verticale des blocs d'eau : la surface déformée par les vagues sort de
+// la boîte d'au plus l'amplitude maximale réglable (1.0)
+#define BVH_WATER_MARGIN 1.0f
+
+// Encodage d'une référence de primitive dans bvhPrims (lu tel quel par le shader)
+#define BVH_PRIM_BLOCK 1        // bit 0 : 0 = sphère, 1 = bloc
+#define BVH_PRIM_NO_SHADOW 2    // bit 1 : ne projette pas d'ombre (eau)
+#define BVH_PRIM_SHIFT 2        // index de la primitive dans les bits suivants
+
+typedef struct {
+    Vector3 min;
+    Vector3 max;
+} Aabb;
+
+// Nœud aplati, 2 texels RGBA32F :
+// texel 0 = min + leftFirst, texel 1 = max + count (entiers lus avec floatBitsToInt).
+// Feuille : count > 0 et leftFirst = première référence ; nœud interne : count = 0
+// et leftFirst = fils gauche (le fils droit le suit immédiatement).
+typedef struct {
+    Vector3 min;
+    int leftFirst;
+    Vector3 max;
+    int count;
+} BvhNode;
+
+static_assert(sizeof(BvhNode) == 2*16, "BvhNode doit faire 2 texels RGBA32F");
+
+// BVH sur les sphères et les blocs de la scène, construit sur CPU (SAH par classes)
+// puis envoyé au GPU dans deux texture buffers (nœuds et références de primitives)
+struct BvhRebuild;
+
+typedef struct {
+    std::vector<BvhNode> nodes;
+    std::vector<int> parents;       // Parent de chaque nœud (-1 pour la racine)
+    std::vector<int> primIds;       // Primitive de chaque emplacement de feuille (sphères puis blocs)
+    std::vector<int> primRefs;      // Même ordre, encodé pour le shader
+    std::vector<int> primLeaf;      // Feuille contenant chaque primitive (indexée par identifiant)
+    std::vector<Aabb> primBounds;   // Boîte de chaque primitive (indexée par identifiant)
+    std::vector<Vector3> centroids;
+    int nodeCount;
+
+    float sahSum;                   // Somme pondérée des surfaces des nœuds (tenue à jour par le refit)
+    float builtSahCost;             // Coût SAH juste après la dernière construction
+    unsigned int layoutVersion;     // layoutVersion de la scène au moment de la construction
+
+    // Nœuds modifiés par le refit depuis le dernier envoi
+    std::vector<int> refitNodes;
+    std::vector<unsigned char> refitQueued;
+
+    SceneTextureBuffer nodeBuffer;
+    SceneTextureBuffer primBuffer;
+
+    struct BvhRebuild *rebuild;     // Reconstruction en cours dans un autre thread (ou NULL)
+
+    float buildMs;                  // Durée de la dernière construction (CPU)
+    int refitCount;                 // Nœuds mis à jour par le dernier UpdateBvh
+    int rebuildCount;               // Reconstructions d'arrière-plan adoptées
+} Bvh;
+
+void InitBvh(Bvh *bvh);
+void UnloadBvh(Bvh *bvh);
+
+// Reconstruction complète et immédiate à partir de la scène
+void BuildBvh(Bvh *bvh, const SceneStorage *storage);
+
+// Mise à jour pour la frame : reconstruction si des primitives ont été ajoutées ou
+// retirées, sinon refit des seules primitives déplacées et de leurs ancêtres (coût
+// proportionnel au nombre d'objets en mouvement). Lance une reconstruction en
+// arrière-plan quand la qualité de l'arbre se dégrade, et l'adopte une fois prête.
+// Vide les listes de déplacements de la scène.
+void UpdateBvh(Bvh *bvh, SceneStorage *storage);
+
+// Coût SAH de l'arbre (relatif à la surface de la racine)
+float GetBvhSahCost(const Bvh *bvh);
+
+// Envoi des nœuds et références modifiés, retourne le nombre d'octets envoyés
+unsigned int UploadBvh(Bvh *bvh);
+
+// Liaison des samplers bvhNodes / bvhPrims d'un shader à leurs unités de texture
+void BindBvhSamplers(Shader shader);
+
+#endif // BVH_H
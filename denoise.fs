@@ -4,30 +4,39 @@ in vec2 fragTexCoord;
 out vec4 fragColor;
 
 // Textures d'entrée (liées depuis Raylib avec SetShaderValueTexture)
-uniform sampler2D renderNoisy;     // image bruitée
-uniform sampler2D renderNormals;   // normales + profondeur dans alpha
+uniform sampler2D renderNoisy;     // image bruitée (ou sortie du niveau précédent)
+uniform sampler2D renderNormals;   // normales + profondeur linéaire dans alpha (G-buffer de raytest.fs)
+uniform sampler2D renderMaterial;  // type de matériau + 1 (0 = ciel)
 uniform sampler2D renderHistory;   // frame précédente
+uniform sampler2D renderReprojection;  // déplacement vers la frame précédente + validité (G-buffer)
 
 // Uniformes
 uniform vec2 resolution;
+uniform vec2 renderScale;      // Part des textures rendue (résolution dynamique), 1 = pleine résolution
 uniform float time;
 uniform int frame;
-uniform float u_denoiseStrength; // force du débruitage
 
-// Constantes pour le filtre À-Trous
-const float c_phi = 1.0;
-const float n_phi = 128.0;
-const float p_phi = 1.0;
+// Paramètres du niveau À-Trous courant (réglés par atrous.cpp)
+uniform float u_stepWidth;     // écart entre deux taps : 2^niveau pixels
+uniform float u_colorPhi;      // tolérance sur la couleur
+uniform float u_normalPhi;     // exposant sur dot(n, n') : ne mélange que des normales quasi parallèles
+uniform float u_depthPhi;      // écart de profondeur toléré, relatif à la profondeur du pixel
+uniform float u_historyBlend;  // mélange avec la frame précédente (dernier niveau seulement)
+
+// Noyau B3-spline 1D (1/16, 1/4, 3/8, 1/4, 1/16), indexé par |offset|
+const float kernel[3] = float[](3.0/8.0, 1.0/4.0, 1.0/16.0);
 
 void main() {
     vec2 uv = fragTexCoord;
     vec2 pixel = 1.0 / resolution;
 
     vec3 cval = texture(renderNoisy, uv).rgb;
-    vec3 nval = texture(renderNormals, uv).rgb;
-    float zval = texture(renderNormals, uv).a;
+    vec4 nzval = texture(renderNormals, uv);
+    vec3 nval = nzval.rgb;
+    float zval = nzval.a;
+    float mval = texture(renderMaterial, uv).r;
 
-    float stepwidth = u_denoiseStrength;
+    float stepwidth = u_stepWidth;
 
     vec3 sum = vec3(0.0);
     float cum_w = 0.0;
@@ -35,19 +44,23 @@ void main() {
     for (int i = -2; i <= 2; ++i) {
         for (int j = -2; j <= 2; ++j) {
             vec2 offset = vec2(i, j) * stepwidth * pixel;
-            vec2 tc = uv + offset;
+            vec2 tc = clamp(uv + offset, 0.5 * pixel, renderScale - 0.5 * pixel);  // pas de répétition aux bords
 
             vec3 ctmp = texture(renderNoisy, tc).rgb;
-            vec3 ntmp = texture(renderNormals, tc).rgb;
-            float ztmp = texture(renderNormals, tc).a;
+            vec4 nztmp = texture(renderNormals, tc);
+            float mtmp = texture(renderMaterial, tc).r;
 
             float dist2 = dot(ctmp - cval, ctmp - cval);
-            float c_w = min(exp(-dist2 / (c_phi * c_phi)), 1.0);
+            float c_w = min(exp(-dist2 / (u_colorPhi * u_colorPhi)), 1.0);
+
+            float n_w = pow(max(dot(nztmp.rgb, nval), 0.0), u_normalPhi);
+            float r_w = exp(-abs(nztmp.a - zval) / (u_depthPhi * zval + 1e-4));
+            float m_w = (mtmp == mval) ? 1.0 : 0.0;
 
-            float n_w = min(exp(-dot(ntmp - nval, ntmp - nval) / (n_phi * n_phi)), 1.0);
-            float r_w = min(exp(-pow(ztmp - zval, 2.0) / (p_phi * p_phi)), 1.0);
+            // Ciel : pas de normale, seule la couleur et le matériau comptent
+            if (mval == 0.0) n_w = 1.0;
 
-            float weight = c_w * n_w * r_w;
+            float weight = kernel[abs(i)] * kernel[abs(j)] * c_w * n_w * r_w * m_w;
             sum += ctmp * weight;
             cum_w += weight;
         }
@@ -55,9 +68,11 @@ void main() {
 
     vec3 colorFiltered = sum / cum_w;
 
-    // Feedback simple avec blending temporel (tu peux ajuster le facteur)
-    vec3 prev = texture(renderHistory, uv).rgb;
-    vec3 blended = mix(colorFiltered, prev, 0.1); // 0.1 = blending léger
+    // Feedback simple avec blending temporel (0.1 = blending léger, au dernier niveau)
+    // (l'historique est à la résolution de sortie, lu au point reprojeté)
+    vec4 motion = texture(renderReprojection, uv);
+    vec3 prev = (motion.z > 0.5) ? texture(renderHistory, uv / renderScale + motion.xy).rgb : colorFiltered;
+    vec3 blended = mix(colorFiltered, prev, u_historyBlend);
 
     fragColor = vec4(blended, 1.0);
 }
@@ -0,0 +1,111 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "denoise_taa.h"
+#include "rlgl.h"
+
+bool LoadDenoiseTaaPass(DenoiseTaaPass *pass, const char *fileName) {
+    pass->program = 0;
+    if (!GLEW_VERSION_4_3) {
+        TraceLog(LOG_INFO, "DENOISE: OpenGL 4.3 indisponible, passes fragment conservées");
+        return false;
+    }
+
+    char *source = LoadFileText(fileName);
+    if (source == NULL) return false;
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, (const GLchar **)&source, NULL);
+    glCompileShader(shader);
+    UnloadFileText(source);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        TraceLog(LOG_WARNING, "DENOISE: [%s] Compilation impossible :\n%s", fileName, log);
+        glDeleteShader(shader);
+        return false;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glDeleteShader(shader);
+
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        TraceLog(LOG_WARNING, "DENOISE: [%s] Édition de liens impossible :\n%s", fileName, log);
+        glDeleteProgram(program);
+        return false;
+    }
+
+    pass->program = program;
+    pass->noisyLoc = glGetUniformLocation(program, "renderNoisy");
+    pass->normalsLoc = glGetUniformLocation(program, "renderNormals");
+    pass->materialLoc = glGetUniformLocation(program, "renderMaterial");
+    pass->historyLoc = glGetUniformLocation(program, "renderHistory");
+    pass->reprojectionLoc = glGetUniformLocation(program, "renderReprojection");
+    pass->resolutionLoc = glGetUniformLocation(program, "resolution");
+    pass->inputSizeLoc = glGetUniformLocation(program, "inputSize");
+    pass->renderScaleLoc = glGetUniformLocation(program, "renderScale");
+    pass->colorPhiLoc = glGetUniformLocation(program, "u_colorPhi");
+    pass->normalPhiLoc = glGetUniformLocation(program, "u_normalPhi");
+    pass->depthPhiLoc = glGetUniformLocation(program, "u_depthPhi");
+    pass->historyBlendLoc = glGetUniformLocation(program, "u_historyBlend");
+
+    // Les samplers restent sur des unités fixes
+    glUseProgram(program);
+    glUniform1i(pass->noisyLoc, DENOISE_TAA_TEXTURE_UNIT);
+    glUniform1i(pass->normalsLoc, DENOISE_TAA_TEXTURE_UNIT + 1);
+    glUniform1i(pass->materialLoc, DENOISE_TAA_TEXTURE_UNIT + 2);
+    glUniform1i(pass->historyLoc, DENOISE_TAA_TEXTURE_UNIT + 3);
+    glUniform1i(pass->reprojectionLoc, DENOISE_TAA_TEXTURE_UNIT + 4);
+    glUseProgram(0);
+
+    TraceLog(LOG_INFO, "DENOISE: [%s] Passe compute chargée", fileName);
+    return true;
+}
+
+void UnloadDenoiseTaaPass(DenoiseTaaPass *pass) {
+    if (pass->program != 0) glDeleteProgram(pass->program);
+    pass->program = 0;
+}
+
+void DispatchDenoiseTaaPass(const DenoiseTaaPass *pass, const AtrousLevel *level, Texture2D noisy, Texture2D normals,
+                            Texture2D material, Texture2D reprojection, Texture2D history, Texture2D output,
+                            int inputWidth, int inputHeight) {
+    // Les rendus en attente dans le batch de raylib doivent précéder la passe
+    rlDrawRenderBatchActive();
+
+    glUseProgram(pass->program);
+    glUniform2f(pass->resolutionLoc, (float)output.width, (float)output.height);
+    glUniform2f(pass->inputSizeLoc, (float)inputWidth, (float)inputHeight);
+    glUniform2f(pass->renderScaleLoc, (float)inputWidth/(float)output.width, (float)inputHeight/(float)output.height);
+    glUniform1f(pass->colorPhiLoc, level->colorPhi);
+    glUniform1f(pass->normalPhiLoc, level->normalPhi);
+    glUniform1f(pass->depthPhiLoc, level->depthPhi);
+    glUniform1f(pass->historyBlendLoc, ATROUS_HISTORY_BLEND);
+
+    glActiveTexture(GL_TEXTURE0 + DENOISE_TAA_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, noisy.id);
+    glActiveTexture(GL_TEXTURE0 + DENOISE_TAA_TEXTURE_UNIT + 1);
+    glBindTexture(GL_TEXTURE_2D, normals.id);
+    glActiveTexture(GL_TEXTURE0 + DENOISE_TAA_TEXTURE_UNIT + 2);
+    glBindTexture(GL_TEXTURE_2D, material.id);
+    glActiveTexture(GL_TEXTURE0 + DENOISE_TAA_TEXTURE_UNIT + 3);
+    glBindTexture(GL_TEXTURE_2D, history.id);
+    glActiveTexture(GL_TEXTURE0 + DENOISE_TAA_TEXTURE_UNIT + 4);
+    glBindTexture(GL_TEXTURE_2D, reprojection.id);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindImageTexture(0, output.id, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    glDispatchCompute((output.width + DENOISE_TAA_TILE_SIZE - 1)/DENOISE_TAA_TILE_SIZE,
+                      (output.height + DENOISE_TAA_TILE_SIZE - 1)/DENOISE_TAA_TILE_SIZE, 1);
+
+    // La sortie est ensuite lue comme texture (affichage, frame suivante)
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    glUseProgram(0);
+}
@@ -0,0 +1,44 @@
+#ifndef DENOISE_TAA_H
+#define DENOISE_TAA_H
+
+#include "raylib.h"
+#include "atrous.h"
+
+// Unités de texture utilisées par la passe compute (12 à 16)
+#define DENOISE_TAA_TEXTURE_UNIT 12
+
+// Taille des tuiles traitées par groupe (TILE_SIZE dans denoise_taa.comp)
+#define DENOISE_TAA_TILE_SIZE 16
+
+// Dernier niveau À-Trous (pas 1) + TAA fusionnés en une passe compute (denoise_taa.comp).
+// Nécessite OpenGL 4.3 : sinon program vaut 0 et les passes fragment
+// denoise.fs / taa.fs restent utilisées.
+typedef struct {
+    unsigned int program;
+    int noisyLoc;
+    int normalsLoc;
+    int materialLoc;
+    int historyLoc;
+    int reprojectionLoc;
+    int resolutionLoc;
+    int inputSizeLoc;
+    int renderScaleLoc;
+    int colorPhiLoc;
+    int normalPhiLoc;
+    int depthPhiLoc;
+    int historyBlendLoc;
+} DenoiseTaaPass;
+
+bool LoadDenoiseTaaPass(DenoiseTaaPass *pass, const char *fileName);
+void UnloadDenoiseTaaPass(DenoiseTaaPass *pass);
+
+// Lit l'image (bruitée ou sortie des niveaux précédents), le G-buffer et
+// l'historique (au point reprojeté par raytest.fs), filtre avec les paramètres du niveau 0 et écrit la couleur
+// finale (et le taux de mélange en alpha) dans output, qui doit être en RGBA8.
+// Seuls les inputWidth x inputHeight premiers pixels des entrées sont rendus
+// (résolution dynamique) : ils sont suréchantillonnés à la taille de output.
+void DispatchDenoiseTaaPass(const DenoiseTaaPass *pass, const AtrousLevel *level, Texture2D noisy, Texture2D normals,
+                            Texture2D material, Texture2D reprojection, Texture2D history, Texture2D output,
+                            int inputWidth, int inputHeight);
+
+#endif // DENOISE_TAA_H
@@ -0,0 +1,42 @@
+#include "dynamic_resolution.h"
+#include <math.h>
+
+static void ApplyScale(DynamicResolution *dr, float scale) {
+    if (scale < DYNAMIC_RESOLUTION_MIN_SCALE) scale = DYNAMIC_RESOLUTION_MIN_SCALE;
+    if (scale > DYNAMIC_RESOLUTION_MAX_SCALE) scale = DYNAMIC_RESOLUTION_MAX_SCALE;
+
+    dr->scale = scale;
+    dr->width = (int)((float)dr->fullWidth*scale + 0.5f);
+    dr->height = (int)((float)dr->fullHeight*scale + 0.5f);
+    if (dr->width < 1) dr->width = 1;
+    if (dr->height < 1) dr->height = 1;
+}
+
+void InitDynamicResolution(DynamicResolution *dr, int fullWidth, int fullHeight, float targetMs) {
+    dr->enabled = false;
+    dr->targetMs = targetMs;
+    dr->filteredMs = 0.0f;
+    dr->fullWidth = fullWidth;
+    dr->fullHeight = fullHeight;
+    ApplyScale(dr, 1.0f);
+}
+
+void UpdateDynamicResolution(DynamicResolution *dr, float gpuMs) {
+    if (!dr->enabled || (gpuMs <= 0.0f)) return;
+
+    dr->filteredMs = (dr->filteredMs == 0.0f) ? gpuMs :
+                     dr->filteredMs*DYNAMIC_RESOLUTION_SMOOTHING + gpuMs*(1.0f - DYNAMIC_RESOLUTION_SMOOTHING);
+
+    // Dans la zone morte, on ne touche à rien (pas d'oscillation autour de la cible)
+    float error = (dr->filteredMs - dr->targetMs)/dr->targetMs;
+    if (fabsf(error) < DYNAMIC_RESOLUTION_DEADBAND) return;
+
+    float desired = dr->scale*sqrtf(dr->targetMs/dr->filteredMs);
+    ApplyScale(dr, dr->scale + (desired - dr->scale)*DYNAMIC_RESOLUTION_GAIN);
+}
+
+void SetDynamicResolutionEnabled(DynamicResolution *dr, bool enabled) {
+    dr->enabled = enabled;
+    dr->filteredMs = 0.0f;
+    if (!enabled) ApplyScale(dr, 1.0f);
+}
@@ -0,0 +1,36 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.5f
+#define DYNAMIC_RESOLUTION_MAX_SCALE 1.0f
+#define DYNAMIC_RESOLUTION_DEFAULT_TARGET_MS 16.6f
+#define DYNAMIC_RESOLUTION_DEADBAND 0.05f    // Écart relatif à la cible toléré sans correction
+#define DYNAMIC_RESOLUTION_GAIN 0.25f        // Part de la correction appliquée à chaque frame
+#define DYNAMIC_RESOLUTION_SMOOTHING 0.8f    // Lissage des mesures (moyenne glissante)
+
+// Régulation de la résolution interne du raytracing pour tenir un temps GPU
+// cible. Les render targets gardent la taille de la fenêtre : seul le coin
+// width x height est tracé puis débruité, le TAA suréchantillonne vers la
+// sortie. Le temps de calcul étant proportionnel au nombre de pixels, l'échelle
+// visée est scale * sqrt(cible / mesure).
+typedef struct {
+    bool enabled;
+    float targetMs;         // Temps GPU visé (raytracing + post-traitement)
+    float scale;            // Échelle courante, par axe
+    float filteredMs;       // Mesure lissée
+    int fullWidth;
+    int fullHeight;
+    int width;              // Résolution interne courante
+    int height;
+} DynamicResolution;
+
+void InitDynamicResolution(DynamicResolution *dr, int fullWidth, int fullHeight, float targetMs);
+
+// Prend en compte le temps GPU mesuré de la dernière frame disponible (les
+// mesures ont quelques frames de retard, d'où une correction progressive)
+void UpdateDynamicResolution(DynamicResolution *dr, float gpuMs);
+
+// Active ou coupe la régulation (pleine résolution quand elle est coupée)
+void SetDynamicResolutionEnabled(DynamicResolution *dr, bool enabled);
+
+#endif // DYNAMIC_RESOLUTION_H
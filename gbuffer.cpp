@@ -0,0 +1,61 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "gbuffer.h"
+#include "rlgl.h"
+#include <stddef.h>
+
+static Texture2D LoadGBufferTexture(int width, int height, int format) {
+    Texture2D texture = { 0 };
+    texture.id = rlLoadTexture(NULL, width, height, format, 1);
+    texture.width = width;
+    texture.height = height;
+    texture.mipmaps = 1;
+    texture.format = format;
+    return texture;
+}
+
+GBuffer LoadGBuffer(int width, int height) {
+    GBuffer gbuffer = { 0 };
+    gbuffer.target = LoadRenderTexture(width, height);
+
+    gbuffer.normals = LoadGBufferTexture(width, height, PIXELFORMAT_UNCOMPRESSED_R16G16B16A16);
+    gbuffer.previousNormals = LoadGBufferTexture(width, height, PIXELFORMAT_UNCOMPRESSED_R16G16B16A16);
+    gbuffer.material = LoadGBufferTexture(width, height, PIXELFORMAT_UNCOMPRESSED_R16);
+    gbuffer.reprojection = LoadGBufferTexture(width, height, PIXELFORMAT_UNCOMPRESSED_R16G16B16A16);
+    gbuffer.pathStats = LoadGBufferTexture(width, height, PIXELFORMAT_UNCOMPRESSED_R16G16B16A16);
+
+    rlFramebufferAttach(gbuffer.target.id, gbuffer.normals.id, RL_ATTACHMENT_COLOR_CHANNEL1, RL_ATTACHMENT_TEXTURE2D, 0);
+    rlFramebufferAttach(gbuffer.target.id, gbuffer.material.id, RL_ATTACHMENT_COLOR_CHANNEL2, RL_ATTACHMENT_TEXTURE2D, 0);
+    rlFramebufferAttach(gbuffer.target.id, gbuffer.reprojection.id, RL_ATTACHMENT_COLOR_CHANNEL3, RL_ATTACHMENT_TEXTURE2D, 0);
+    rlFramebufferAttach(gbuffer.target.id, gbuffer.pathStats.id, RL_ATTACHMENT_COLOR_CHANNEL4, RL_ATTACHMENT_TEXTURE2D, 0);
+
+    // Les draw buffers font partie de l'état du framebuffer : réglés une fois ici
+    rlEnableFramebuffer(gbuffer.target.id);
+    rlActiveDrawBuffers(5);
+    rlDisableFramebuffer();
+
+    if (!rlFramebufferComplete(gbuffer.target.id)) TraceLog(LOG_WARNING, "GBUFFER: Framebuffer incomplet");
+
+    return gbuffer;
+}
+
+void UnloadGBuffer(GBuffer *gbuffer) {
+    UnloadRenderTexture(gbuffer->target);
+    rlUnloadTexture(gbuffer->normals.id);
+    rlUnloadTexture(gbuffer->material.id);
+    rlUnloadTexture(gbuffer->reprojection.id);
+    rlUnloadTexture(gbuffer->pathStats.id);
+    rlUnloadTexture(gbuffer->previousNormals.id);
+}
+
+void SwapGBufferHistory(GBuffer *gbuffer) {
+    Texture2D previous = gbuffer->normals;
+    gbuffer->normals = gbuffer->previousNormals;
+    gbuffer->previousNormals = previous;
+    rlFramebufferAttach(gbuffer->target.id, gbuffer->normals.id, RL_ATTACHMENT_COLOR_CHANNEL1, RL_ATTACHMENT_TEXTURE2D, 0);
+}
+
+void ClearGBufferPathStats(void) {
+    const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 4, zero);
+}
@@ -0,0 +1,32 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include "raylib.h"
+
+// Valeurs écrites pour les pixels sans impact (ciel)
+#define GBUFFER_SKY_DEPTH 10000.0f
+#define GBUFFER_SKY_MATERIAL 0.0f
+
+// Cible de la passe de raytracing (MRT) : en plus de la couleur, raytest.fs
+// écrit les informations du premier impact qui guident le débruitage
+typedef struct {
+    RenderTexture2D target;   // Framebuffer, couleur bruitée (attachement 0) et profondeur
+    Texture2D normals;        // Attachement 1 : normale (xyz) + profondeur linéaire (a), RGBA16F
+    Texture2D material;       // Attachement 2 : type de matériau + 1 (0 = ciel), R16F
+    Texture2D reprojection;   // Attachement 3 : déplacement vers la frame précédente (xy, uv) + validité (z), RGBA16F
+    Texture2D pathStats;      // Attachement 4 : statistiques de longueur des chemins (path_stats.h), RGBA16F
+    Texture2D previousNormals; // normals de la frame précédente, lu par raytest.fs pour rejeter les désocclusions
+} GBuffer;
+
+GBuffer LoadGBuffer(int width, int height);
+void UnloadGBuffer(GBuffer *gbuffer);
+
+// Échange normals et previousNormals avant de tracer une nouvelle frame : la
+// frame précédente reste lisible sans copie
+void SwapGBufferHistory(GBuffer *gbuffer);
+
+// Remise à zéro des statistiques de chemin (framebuffer actif) : la partie non
+// rendue en résolution dynamique ne garde pas les valeurs d'anciennes frames
+void ClearGBufferPathStats(void);
+
+#endif // GBUFFER_H
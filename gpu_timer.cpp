@@ -0,0 +1,49 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "gpu_timer.h"
+
+void LoadGpuTimer(GpuTimer *timer) {
+    glGenQueries(GPU_TIMER_QUERY_COUNT, timer->queries);
+    for (int i = 0; i < GPU_TIMER_QUERY_COUNT; i++) timer->pending[i] = false;
+    timer->current = 0;
+    timer->lastMs = 0.0f;
+    timer->averageMs = 0.0f;
+}
+
+void UnloadGpuTimer(GpuTimer *timer) {
+    glDeleteQueries(GPU_TIMER_QUERY_COUNT, timer->queries);
+}
+
+void BeginGpuTimer(GpuTimer *timer) {
+    // Si la requête n'a pas encore été lue (GPU très en retard), on la récupère d'abord
+    if (timer->pending[timer->current]) ReadGpuTimer(timer, true);
+    glBeginQuery(GL_TIME_ELAPSED, timer->queries[timer->current]);
+}
+
+void EndGpuTimer(GpuTimer *timer) {
+    glEndQuery(GL_TIME_ELAPSED);
+    timer->pending[timer->current] = true;
+    timer->current = (timer->current + 1) % GPU_TIMER_QUERY_COUNT;
+}
+
+float ReadGpuTimer(GpuTimer *timer, bool wait) {
+    // Parcours des requêtes de la plus ancienne à la plus récente
+    for (int k = 0; k < GPU_TIMER_QUERY_COUNT; k++) {
+        int i = (timer->current + k) % GPU_TIMER_QUERY_COUNT;
+        if (!timer->pending[i]) continue;
+
+        GLint available = 0;
+        if (!wait) {
+            glGetQueryObjectiv(timer->queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;  // Les suivantes ne sont pas prêtes non plus
+        }
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(timer->queries[i], GL_QUERY_RESULT, &elapsed);
+        timer->pending[i] = false;
+        timer->lastMs = (float)((double)elapsed/1.0e6);
+        timer->averageMs = (timer->averageMs == 0.0f) ? timer->lastMs : timer->averageMs*0.9f + timer->lastMs*0.1f;
+    }
+
+    return timer->lastMs;
+}
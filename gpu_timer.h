@@ -0,0 +1,27 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+// Nombre de requêtes en vol : le résultat lu a quelques frames de retard mais
+// la lecture ne bloque jamais le CPU en attendant le GPU
+#define GPU_TIMER_QUERY_COUNT 4
+
+// Mesure du temps GPU d'une passe (requêtes GL_TIME_ELAPSED)
+typedef struct {
+    unsigned int queries[GPU_TIMER_QUERY_COUNT];
+    bool pending[GPU_TIMER_QUERY_COUNT];
+    int current;        // Requête utilisée par le prochain BeginGpuTimer
+    float lastMs;       // Dernier résultat disponible (millisecondes)
+    float averageMs;    // Moyenne glissante (millisecondes)
+} GpuTimer;
+
+void LoadGpuTimer(GpuTimer *timer);
+void UnloadGpuTimer(GpuTimer *timer);
+
+// Encadre les commandes à mesurer (une seule mesure GL_TIME_ELAPSED peut être active à la fois)
+void BeginGpuTimer(GpuTimer *timer);
+void EndGpuTimer(GpuTimer *timer);
+
+// Récupère les résultats disponibles sans attendre ; si wait est vrai, attend la dernière mesure
+float ReadGpuTimer(GpuTimer *timer, bool wait);
+
+#endif // GPU_TIMER_H
@@ -0,0 +1,61 @@
+#include "interleave.h"
+
+void LoadInterleavedTracing(InterleavedTracing *it, const char *fileName, int width, int height) {
+    it->shader = LoadShader(0, fileName);
+    it->noisyLoc = GetShaderLocation(it->shader, "renderNoisy");
+    it->normalsLoc = GetShaderLocation(it->shader, "renderNormals");
+    it->materialLoc = GetShaderLocation(it->shader, "renderMaterial");
+    it->reprojectionLoc = GetShaderLocation(it->shader, "renderReprojection");
+    it->historyLoc = GetShaderLocation(it->shader, "renderHistory");
+    it->resolutionLoc = GetShaderLocation(it->shader, "resolution");
+    it->renderScaleLoc = GetShaderLocation(it->shader, "renderScale");
+
+    it->target = LoadRenderTexture(width, height);
+    it->count = 1;
+    it->phase = 0;
+}
+
+void UnloadInterleavedTracing(InterleavedTracing *it) {
+    UnloadShader(it->shader);
+    UnloadRenderTexture(it->target);
+}
+
+void CycleInterleavedTracing(InterleavedTracing *it) {
+    it->count = (it->count >= INTERLEAVE_MAX_COUNT) ? 1 : it->count*2;
+    it->phase = 0;
+}
+
+void AdvanceInterleavedTracing(InterleavedTracing *it) {
+    it->phase = (it->phase + 1) % it->count;
+}
+
+Texture2D ReconstructInterleavedFrame(InterleavedTracing *it, Texture2D input, const GBuffer *gbuffer, Texture2D history,
+                                      int width, int height) {
+    float resolution[2] = { (float)it->target.texture.width, (float)it->target.texture.height };
+    float renderScale[2] = { (float)width/resolution[0], (float)height/resolution[1] };
+
+    // Sortie copiée telle quelle (BLEND_CUSTOM : ONE, ZERO), comme le G-buffer
+    BeginTextureMode(it->target);
+        BeginBlendMode(BLEND_CUSTOM);
+        BeginShaderMode(it->shader);
+            SetShaderValue(it->shader, it->resolutionLoc, resolution, SHADER_UNIFORM_VEC2);
+            SetShaderValue(it->shader, it->renderScaleLoc, renderScale, SHADER_UNIFORM_VEC2);
+
+            // Même répartition des unités que le débruitage : l'entrée est la texture du quad
+            int noisyUnit = 0;
+            SetShaderValue(it->shader, it->noisyLoc, &noisyUnit, SHADER_UNIFORM_SAMPLER2D);
+            SetShaderValueTexture(it->shader, it->normalsLoc, gbuffer->normals);
+            SetShaderValueTexture(it->shader, it->materialLoc, gbuffer->material);
+            SetShaderValueTexture(it->shader, it->reprojectionLoc, gbuffer->reprojection);
+            SetShaderValueTexture(it->shader, it->historyLoc, history);
+
+            DrawTexturePro(input,
+                           (Rectangle){ 0, 0, (float)width, -(float)height },
+                           (Rectangle){ 0, resolution[1] - (float)height, (float)width, (float)height },
+                           (Vector2){ 0, 0 }, 0.0f, WHITE);
+        EndShaderMode();
+        EndBlendMode();
+    EndTextureMode();
+
+    return it->target.texture;
+}
@@ -0,0 +1,43 @@
+#ifndef INTERLEAVE_H
+#define INTERLEAVE_H
+
+#include "raylib.h"
+#include "gbuffer.h"
+
+#define INTERLEAVE_MAX_COUNT 4      // Un pixel sur 4 (blocs 2x2)
+
+// Tracé entrelacé : raytest.fs ne trace qu'un pixel sur count à chaque frame
+// (1 = tous, 2 = damier, 4 = un par bloc 2x2), le sous-ensemble changeant à
+// chaque frame. Les autres pixels n'ont que leur G-buffer ; la passe de
+// reconstruction (reconstruct.fs) les remplit depuis l'historique reprojeté et
+// les voisins tracés avant le débruitage.
+typedef struct {
+    Shader shader;
+    int noisyLoc;
+    int normalsLoc;
+    int materialLoc;
+    int reprojectionLoc;
+    int historyLoc;
+    int resolutionLoc;
+    int renderScaleLoc;
+
+    RenderTexture2D target;     // Image reconstruite, entrée du débruitage
+    int count;                  // 1, 2 ou INTERLEAVE_MAX_COUNT
+    int phase;                  // Sous-ensemble tracé à la frame courante (0 à count - 1)
+} InterleavedTracing;
+
+void LoadInterleavedTracing(InterleavedTracing *it, const char *fileName, int width, int height);
+void UnloadInterleavedTracing(InterleavedTracing *it);
+
+// Passe au mode suivant (1 -> 2 -> 4 -> 1)
+void CycleInterleavedTracing(InterleavedTracing *it);
+
+// Sous-ensemble suivant, à appeler une fois par frame tracée
+void AdvanceInterleavedTracing(InterleavedTracing *it);
+
+// Remplit les pixels non tracés de input (partie width x height, comme
+// ApplyAtrousFilter) et retourne l'image complète
+Texture2D ReconstructInterleavedFrame(InterleavedTracing *it, Texture2D input, const GBuffer *gbuffer, Texture2D history,
+                                      int width, int height);
+
+#endif // INTERLEAVE_H
@@ -0,0 +1,115 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "light_list.h"
+#include <math.h>
+#include <string.h>
+
+// Types de matériau (raytest.fs)
+#define MATERIAL_EMISSIVE 3
+#define MATERIAL_ZONE_EMISSION 5
+
+static float Luminance(Vector3 c) {
+    return 0.2126f*c.x + 0.7152f*c.y + 0.0722f*c.z;
+}
+
+// Puissance émise, au facteur pi près : luminance de la couleur x surface
+// (même formule que sphereLightPower / blockLightPower dans raytest.fs)
+static float SphereLightPower(const SphereRecord *record) {
+    float r = record->sphere.radius;
+    return Luminance(record->material.albedo)*4.0f*PI*r*r;
+}
+
+static float BlockLightPower(const BlockRecord *record) {
+    Vector3 s = record->size.v;
+    return LIGHT_ZONE_EMISSION_COVERAGE*2.0f*(s.x*s.y + s.y*s.z + s.z*s.x);
+}
+
+void InitLightList(LightList *lights) {
+    lights->entries.clear();
+    lights->totalPower = 0.0f;
+    lights->emitterVersion = (unsigned int)-1;
+    LoadSceneTextureBuffer(&lights->buffer, GL_RGBA32F, LIGHT_LIST_TEXTURE_UNIT);
+}
+
+void UnloadLightList(LightList *lights) {
+    UnloadSceneTextureBuffer(&lights->buffer);
+    lights->entries.clear();
+}
+
+void UpdateLightList(LightList *lights, const SceneStorage *storage) {
+    // La puissance ne dépend pas de la position : une sphère qui tombe ou un
+    // bloc déplacé ne reconstruit pas la table
+    if (lights->emitterVersion == storage->emitterVersion) return;
+    lights->emitterVersion = storage->emitterVersion;
+
+    std::vector<int> refs;
+    std::vector<float> power;
+    for (int i = 0; i < (int)storage->spheres.size(); i++) {
+        if (storage->spheres[i].material.type != MATERIAL_EMISSIVE) continue;
+        float p = SphereLightPower(&storage->spheres[i]);
+        if (p <= 0.0f) continue;
+        refs.push_back(i << LIGHT_REF_SHIFT);
+        power.push_back(p);
+    }
+    for (int i = 0; i < (int)storage->blocks.size(); i++) {
+        if (storage->blocks[i].material.type != MATERIAL_ZONE_EMISSION) continue;
+        float p = BlockLightPower(&storage->blocks[i]);
+        if (p <= 0.0f) continue;
+        refs.push_back((i << LIGHT_REF_SHIFT) | LIGHT_REF_BLOCK);
+        power.push_back(p);
+    }
+
+    int count = (int)refs.size();
+    float total = 0.0f;
+    for (int i = 0; i < count; i++) total += power[i];
+
+    // Table d'alias (méthode de Vose) : chaque case reçoit une masse 1/count,
+    // complétée si besoin par une source de masse excédentaire
+    std::vector<LightEntry> entries(count);
+    std::vector<float> scaled(count);
+    std::vector<int> small, large;
+    for (int i = 0; i < count; i++) {
+        entries[i].ref = refs[i];
+        entries[i].pdf = power[i]/total;
+        entries[i].alias = i;
+        scaled[i] = power[i]*(float)count/total;
+        if (scaled[i] < 1.0f) small.push_back(i);
+        else large.push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        int s = small.back(); small.pop_back();
+        int l = large.back(); large.pop_back();
+        entries[s].probability = scaled[s];
+        entries[s].alias = l;
+        scaled[l] -= 1.0f - scaled[s];
+        if (scaled[l] < 1.0f) small.push_back(l);
+        else large.push_back(l);
+    }
+    // Restes (erreurs d'arrondi) : la case garde sa propre source
+    for (int i : small) entries[i].probability = 1.0f;
+    for (int i : large) entries[i].probability = 1.0f;
+
+    // Seules les entrées réellement modifiées partent (la table change rarement)
+    if (count != (int)lights->entries.size()) {
+        InvalidateSceneTextureBuffer(&lights->buffer);
+    } else {
+        for (int i = 0; i < count; i++) {
+            if (memcmp(&entries[i], &lights->entries[i], sizeof(LightEntry)) != 0) MarkSceneTextureBufferDirty(&lights->buffer, i);
+        }
+    }
+    lights->entries.swap(entries);
+    lights->totalPower = total;
+}
+
+unsigned int UploadLightList(LightList *lights) {
+    return UploadSceneTextureBuffer(&lights->buffer, lights->entries.data(), (unsigned int)lights->entries.size(), sizeof(LightEntry));
+}
+
+int GetLightCount(const LightList *lights) {
+    return (int)lights->entries.size();
+}
+
+void BindLightListSampler(Shader shader) {
+    int unit = LIGHT_LIST_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "lightList"), &unit, SHADER_UNIFORM_INT);
+}
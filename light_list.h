@@ -0,0 +1,56 @@
+#ifndef LIGHT_LIST_H
+#define LIGHT_LIST_H
+
+#include "raylib.h"
+#include "scene_storage.h"
+#include <vector>
+
+// Unité de texture réservée à la table des sources (raylib n'utilise que 0 à 4)
+#define LIGHT_LIST_TEXTURE_UNIT 6
+
+// Encodage d'une source dans la table (lu tel quel par le shader)
+#define LIGHT_REF_BLOCK 1       // bit 0 : 0 = sphère émissive, 1 = bloc MAT_ZONE_EMISSION
+#define LIGHT_REF_SHIFT 1       // index de la primitive dans les bits suivants
+
+// Part allumée d'un bloc MAT_ZONE_EMISSION (seuil 0.8 de emissionPattern dans raytest.fs)
+#define LIGHT_ZONE_EMISSION_COVERAGE 0.2f
+
+// Entrée de la table d'alias, 1 texel RGBA32F (entiers lus avec floatBitsToInt) :
+// la case i garde la source i avec la probabilité probability, sinon la source alias
+typedef struct {
+    float probability;
+    int alias;
+    int ref;            // Source de la case (LIGHT_REF_*)
+    float pdf;          // Probabilité de tirer cette source (puissance / puissance totale)
+} LightEntry;
+
+static_assert(sizeof(LightEntry) == 16, "LightEntry doit faire 1 texel RGBA32F");
+
+// Sources de la scène (sphères émissives et blocs MAT_ZONE_EMISSION) dans une
+// table d'alias pondérée par leur puissance : le shader tire une source en
+// temps constant quel que soit leur nombre. La puissance ne dépend que de la
+// taille et de la couleur des primitives, pas de leur position.
+typedef struct {
+    std::vector<LightEntry> entries;
+    float totalPower;               // Somme des puissances (SceneBlock.lightTotalPower)
+    unsigned int emitterVersion;    // emitterVersion de la scène au moment de la construction
+    SceneTextureBuffer buffer;
+} LightList;
+
+void InitLightList(LightList *lights);
+void UnloadLightList(LightList *lights);
+
+// Reconstruit la table si les sources ont changé (matériau, taille, ajout ou
+// retrait, pas les déplacements) ; seules les entrées modifiées sont marquées
+// pour l'envoi
+void UpdateLightList(LightList *lights, const SceneStorage *storage);
+
+// Envoi des entrées modifiées, retourne le nombre d'octets envoyés
+unsigned int UploadLightList(LightList *lights);
+
+int GetLightCount(const LightList *lights);
+
+// Liaison du sampler lightList d'un shader à son unité de texture
+void BindLightListSampler(Shader shader);
+
+#endif // LIGHT_LIST_H
@@ -1,11 +1,32 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
 //#include "raygui.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <vector>
 #include <iostream>
+#include "scene.h"
+#include "scene_uniforms.h"
+#include "scene_storage.h"
+#include "bvh.h"
+#include "gpu_timer.h"
+#include "denoise_taa.h"
+#include "gbuffer.h"
+#include "atrous.h"
+#include "raytrace_variants.h"
+#include "progressive.h"
+#include "blue_noise.h"
+#include "dynamic_resolution.h"
+#include "interleave.h"
+#include "light_list.h"
+#include "path_stats.h"
+#include "water_field.h"
+#include "water_bounds.h"
+#include "water_sim.h"
 #define RLIGHTS_IMPLEMENTATION
 #if defined(_WIN32) || defined(_WIN64)
 //#include "include/shaders/rlights.h"
@@ -27,33 +48,8 @@ float distance_cam = 5.0f;
 // Variable pour activer/désactiver la rotation
 bool isRotating = false;
 
-#define MAX_SPHERES 2
-#define MAX_BLOCKS 6
-
-// Structure pour les sphères
-typedef struct {
-    Vector3 position;
-    float radius;
-} Sphere;
-
-//structure pour les blocs (murs)
-typedef struct {
-    Vector3 position;
-    Vector3 size; // Taille du bloc (largeur, hauteur, profondeur)
-} Block;
-
-// Structure pour les matériaux
-typedef struct {
-    int type;         // 0 = diffus, 1 = métallique, 2 = verre, 3 = emissif 4 = mirroir 5 = zone_emition 6 = eau
-    float roughness;  // 0.0 - 1.0
-    float ior;        // indice de réfraction (verre)
-    float padding;    // pour alignement
-    Vector3 albedo;   // couleur
-    float padding2;   // pour alignement
-} Material2;
-
-// Données des sphères
-Sphere spheres[MAX_SPHERES] = {
+// Données des sphères de la scène par défaut (la sphère 0 est animée)
+Sphere spheres[] = {
     {{0.0f, 10.0f, 0.0f}, 1.0f}     // Sphère centrale (commence à y=10)
     //{{1.5f, 0.0f, 1.5f}, 0.5f},      // Petite sphère
     //{{-2.5f, 0.0f, 0.0f}, 1.0f},    // Sphère à gauche
@@ -72,7 +68,7 @@ Sphere spheres[MAX_SPHERES] = {
 //vec3 albedo;    // Couleur de base
 //float padding2; // Padding supplémentaire
 
-Material2 materials[MAX_SPHERES] = {
+Material2 materials[] = {
     {3, 0.0f, 1.0f, 0.0f, {1.0f, 0.50f, 0.0f}, 0.0f}    // Balle miroir
     //{3, 0.0f, 1.0f, 0.0f, {0.9f, 0.9f, 0.0f}, 0.0f}     // Jaune diffus
     //{1, 0.1f, 1.0f, 0.0f, {0.8f, 0.8f, 0.9f}, 0.0f},    // Métal bleuté
@@ -85,7 +81,7 @@ Material2 materials[MAX_SPHERES] = {
 
 //les murs :
 //un grand mur d'eau donc mirroir
-Block blocks[MAX_BLOCKS] = {
+Block blocks[] = {
     {{0.0f, -1.0f, 0.0f}, {200.0f, 0.1f, 200.0f}}  // Sol
     //{{0.0f, 10.0f, 0.0f}, {20.0f, 0.1f, 20.0f}},  // Plafond
     //{{-10.0f, 0.0f, 0.0f}, {0.1f, 20.0f, 20.0f}}, // Mur gauche
@@ -94,7 +90,7 @@ Block blocks[MAX_BLOCKS] = {
     //{{0.0f, 0.0f, 10.0f}, {20.0f, 20.0f, 0.1f}}   // Mur avant
 };
 
-Material2 materials_block[MAX_BLOCKS] = {
+Material2 materials_block[] = {
     {6, 0.80f, 1.0f, 0.0f, {0.2f, 0.2f, 0.225f}, 0.0f} // Mur gauche gris
     //{1, 0.80f, 1.0f, 0.0f, {0.2f, 0.2f, 0.225f}, 0.0f}, // Mur droit gris
     //{1, 0.80f, 1.0f, 0.0f, {0.2f, 0.2f, 0.225f}, 0.0f}, // Mur arrière gris
@@ -103,6 +99,9 @@ Material2 materials_block[MAX_BLOCKS] = {
     //{1, 0.80f, 1.0f, 0.0f, {0.2f, 0.2f, 0.225f}, 0.0f}  // Mur droit avant gris
 };
 
+#define DEFAULT_SPHERE_COUNT (int)(sizeof(spheres)/sizeof(spheres[0]))
+#define DEFAULT_BLOCK_COUNT (int)(sizeof(blocks)/sizeof(blocks[0]))
+
 
 // Position de la lumière
 Vector3 lightPos = {0.f,1.f,0.f};
@@ -125,15 +124,188 @@ bool enableWaves = false;     // Activer/désactiver les vagues
 float waveDuration = 5.0f;   // Durée des vagues (en secondes)
 float waveAmplitude = 0.5f; // Amplitude des vagues
 float waveStartTime = 0.0f;  // Moment où les vagues ont commencé
+WaveSourceRing waveSources = { 0 };  // Impacts dont les vagues sont encore visibles (modèle analytique)
 float waveDecayRate = 0.9f;  // Taux de dissipation (90% = 10% de réduction par seconde)
+bool waterSimulation = false; // Vagues simulées sur CPU (water_sim.h) au lieu du modèle analytique (F10)
+
+// Budget de rebonds par type de matériau (diffus, métal, verre, émissif, miroir,
+// zone d'émission, eau) : roulette russe à partir de la profondeur minimale,
+// arrêt à la maximale (0 = nombre de rebonds du niveau de qualité, -1 = deux
+// fois ce nombre, limite PATH_DEPTH_LIMIT de raytest.fs). Le verre, le miroir
+// et l'eau vont jusqu'à deux fois ce nombre.
+// main --depth <type> <min> <max> pour les régler
+int materialMinDepth[8] = { 1, 2, 3, 1, 3, 1, 3, 1 };
+int materialMaxDepth[8] = { 0, 0, -1, 0, -1, 0, -1, 0 };
+
+// Recopie des paramètres globaux de la scène dans le miroir std140 du bloc SceneBlock
+static void BuildSceneBlock(SceneBlock *block, int sphereCount, int blockCount, int bvhNodeCount, const LightList *lights) {
+    block->lightPos = lightPos;
+    block->lightIntensity = lightIntensity;
+    block->lightColor = lightColor;
+    block->sphereCount = sphereCount;
+
+    block->beamDirection = beamDirection;
+    block->beamAngle = beamAngle;
+    block->beamPosition = beamPosition;
+    block->beamIntensity = beamIntensity;
+    block->beamColor = beamColor;
+    block->enableBeam = enableBeam ? 1 : 0;
+
+    block->waveCenter = waveCenter;
+    block->waveSourceCount = enableWaves ? GetWaveSources(&waveSources, block->waveSources) : 0;
+    block->enableWaves = ((block->waveSourceCount > 0) || waterSimulation) ? 1 : 0;
+    block->waveDuration = waveDuration;
+    block->waveAmplitude = waveAmplitude;
+    block->waveStartTime = waveStartTime;
+    block->waveDecayRate = waveDecayRate;
+    block->blockCount = blockCount;
+    block->bvhNodeCount = bvhNodeCount;
+    block->lightCount = (lights != NULL) ? GetLightCount(lights) : 0;
+    block->lightTotalPower = (lights != NULL) ? lights->totalPower : 0.0f;
+    memcpy(block->materialMinDepth, materialMinDepth, sizeof(block->materialMinDepth));
+    memcpy(block->materialMaxDepth, materialMaxDepth, sizeof(block->materialMaxDepth));
+}
+
+// Vérification (main --water-check) : champ de quelques impacts superposés et
+// sa pyramide, puis rayons rasants du parcours hiérarchique comparés à une
+// marche régulière. Retourne le code de sortie du programme.
+static int RunWaterCheck(SceneBuffer *sceneBuffer, WaterField *field, WaterBounds *bounds) {
+    enableWaves = true;
+    ClearWaveSources(&waveSources);
+    AddWaveSource(&waveSources, 0.0f, 0.0f, 0.0f, 1.0f);
+    AddWaveSource(&waveSources, 6.0f, -4.0f, 1.5f, 0.7f);
+    AddWaveSource(&waveSources, -5.0f, 3.0f, 3.0f, 0.5f);
+
+    SceneBlock block = { 0 };
+    BuildSceneBlock(&block, 0, 0, 0, NULL);
+    UploadSceneBlock(sceneBuffer, &block);
+
+    UpdateWaterField(field, 4.0f, block.waveSources, block.waveSourceCount, true);
+    BindWaterFieldTexture(field->target.texture);
+    UpdateWaterBounds(bounds, field->target.texture, true);
+    return (CheckWaterBoundsTraversal("raytest.fs", field->origin, field->size) == 0) ? 0 : 1;
+}
+
+// Benchmark (main --bench) : temps GPU de la passe de raytracing en fonction du
+// nombre de primitives, avec le BVH puis avec le parcours linéaire
+static void RunSceneBenchmark(Shader shader, SceneStorage *storage, Bvh *bvh, LightList *lights, SceneBuffer *sceneBuffer, RenderTexture2D target) {
+    const int primitiveCounts[] = { 16, 64, 256, 1024, 4096, 16384 };
+    const int linearLimit = 4096;   // Au-delà, le parcours linéaire dépasse le délai du pilote
+    const int warmupFrames = 10;
+    const int measuredFrames = 60;
+
+    GpuTimer timer;
+    LoadGpuTimer(&timer);
+    SceneBlock block = { 0 };
+
+    printf("%10s %10s %12s %14s %14s\n", "primitives", "nodes", "build (ms)", "BVH (ms)", "linear (ms)");
+    for (int c = 0; c < (int)(sizeof(primitiveCounts)/sizeof(primitiveCounts[0])); c++) {
+        int count = primitiveCounts[c];
+
+        // Moitié sphères, moitié boîtes, en plus de la scène par défaut
+        ClearSceneStorage(storage);
+        for (int i = 0; i < DEFAULT_SPHERE_COUNT; i++) AddSceneSphere(storage, spheres[i], materials[i]);
+        for (int i = 0; i < DEFAULT_BLOCK_COUNT; i++) AddSceneBlock(storage, blocks[i], materials_block[i]);
+        GenerateStressScene(storage, count/2, count - count/2, 1234u);
+        UploadSceneStorage(storage);
+        BuildBvh(bvh, storage);
+        UploadBvh(bvh);
+        UpdateLightList(lights, storage);
+        UploadLightList(lights);
+
+        float frameMs[2] = { -1.0f, -1.0f };
+        for (int mode = 0; mode < 2; mode++) {
+            if (mode == 1 && count > linearLimit) break;
+            BuildSceneBlock(&block, (int)storage->spheres.size(), (int)storage->blocks.size(), (mode == 0) ? bvh->nodeCount : 0, lights);
+            UploadSceneBlock(sceneBuffer, &block);
+
+            double total = 0.0;
+            for (int f = 0; f < warmupFrames + measuredFrames; f++) {
+                BeginGpuTimer(&timer);
+                BeginTextureMode(target);
+                    BeginBlendMode(BLEND_CUSTOM);
+                    BeginShaderMode(shader);
+                        DrawRectangle(0, 0, target.texture.width, target.texture.height, WHITE);
+                    EndShaderMode();
+                    EndBlendMode();
+                EndTextureMode();
+                EndGpuTimer(&timer);
+
+                // Attente du résultat : le benchmark mesure chaque frame isolément
+                float ms = ReadGpuTimer(&timer, true);
+                if (f >= warmupFrames) total += ms;
+            }
+            frameMs[mode] = (float)(total/measuredFrames);
+        }
+
+        if (frameMs[1] >= 0.0f) printf("%10i %10i %12.2f %14.2f %14.2f\n", count, bvh->nodeCount, bvh->buildMs, frameMs[0], frameMs[1]);
+        else printf("%10i %10i %12.2f %14.2f %14s\n", count, bvh->nodeCount, bvh->buildMs, frameMs[0], "-");
+        fflush(stdout);
+    }
+
+    UnloadGpuTimer(&timer);
+}
+
+int main(int argc, char **argv) {
+    // Scène de test optionnelle : main --spheres N --blocks M
+    int stressSpheres = 0;
+    int stressBlocks = 0;
+    bool benchmark = false;   // main --bench : mesure le temps GPU puis quitte
+    bool waterCheck = false;  // main --water-check : vérifie le parcours de la surface de l'eau puis quitte
+    int atrousLevels = 0;     // main --atrous N : nombre de niveaux du débruitage (1 à 5)
+    int qualityTier = QUALITY_INTERACTIVE;  // main --quality preview|interactive|final
+    bool useProgressive = false;              // main --progressive : rendu progressif d'une image fixe
+    int progressiveSpp = PROGRESSIVE_DEFAULT_TARGET_SPP;  // main --spp N : objectif du rendu progressif
+    bool useDynamicResolution = false;        // main --dynres : résolution interne régulée (F8)
+    float targetFrameMs = DYNAMIC_RESOLUTION_DEFAULT_TARGET_MS;  // main --target-ms X : temps GPU visé
+    int interleaveCount = 1;                  // main --interleave 1|2|4 : pixels tracés une frame sur N
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) benchmark = true;
+        else if (strcmp(argv[i], "--water-check") == 0) waterCheck = true;
+        else if (strcmp(argv[i], "--progressive") == 0) useProgressive = true;
+        else if (strcmp(argv[i], "--dynres") == 0) useDynamicResolution = true;
+        else if (strcmp(argv[i], "--water-sim") == 0) waterSimulation = true;
+        else if (i + 1 >= argc) break;
+        else if (strcmp(argv[i], "--spheres") == 0) stressSpheres = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--blocks") == 0) stressBlocks = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--atrous") == 0) atrousLevels = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--spp") == 0) progressiveSpp = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--interleave") == 0) interleaveCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--target-ms") == 0) {
+            float ms = (float)atof(argv[++i]);
+            if (ms > 0.0f) targetFrameMs = ms;
+            useDynamicResolution = true;
+        }
+        else if (strcmp(argv[i], "--quality") == 0) {
+            int tier = FindQualityTier(argv[++i]);
+            if (tier >= 0) qualityTier = tier;
+        }
+        else if ((strcmp(argv[i], "--depth") == 0) && (i + 3 < argc)) {
+            int type = atoi(argv[++i]);
+            int minDepth = atoi(argv[++i]);
+            int maxDepth = atoi(argv[++i]);
+            if ((type >= 0) && (type < 8)) {
+                materialMinDepth[type] = minDepth;
+                materialMaxDepth[type] = maxDepth;
+            }
+        }
+    }
+
 
-int main(void) {
     // Initialisation
     const int screenWidth = 1280;
     const int screenHeight = 720;
     
     SetConfigFlags(FLAG_MSAA_4X_HINT); // Enable Multi Sampling Anti Aliasing 4x (if available)
     InitWindow(screenWidth, screenHeight, "Raytracer avancé - GLSL");
+
+    // Chargement des fonctions OpenGL hors rlgl (UBO, ...)
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        TraceLog(LOG_ERROR, "GLEW: Initialisation impossible");
+        CloseWindow();
+        return 1;
+    }
     
     Camera camera = { 0 };
     camera.position = (Vector3){ 0.0f, 2.0f, 6.0f };  // Position initiale de la caméra
@@ -142,60 +314,80 @@ int main(void) {
     camera.fovy = 60.0f;                              // Field of view Y
     camera.projection = CAMERA_PERSPECTIVE;           // Type de projection
 
-    // Chargement du shader de raytracing
-    Shader shader = LoadShader(0, "raytest.fs");
+    // Paramètres de résolution pour le shader
+    float resolution[2] = { (float)screenWidth, (float)screenHeight };
+
+    // Bruit bleu des séquences d'échantillonnage, généré une fois au démarrage
+    BlueNoise blueNoise = LoadBlueNoise(1u);
+
+    // Chargement du shader de raytracing : une permutation compilée par niveau de
+    // qualité, avec ses emplacements d'uniformes résolus une seule fois ici (puis
+    // uniquement lors d'un rechargement du shader)
+    RaytraceVariants raytrace = { 0 };
+    raytrace.current = qualityTier;
+    LoadRaytraceVariants(&raytrace, "raytest.fs", resolution[0], resolution[1]);
     //Shader denoiser_shader = LoadShader(0, "denoiser.fs");
 
-    //test denoiser plusieurs passes
-    Shader denoise_shader = LoadShader(0, "denoise.fs");
     Shader taa_shader = LoadShader(0, "taa.fs");
     
-    // Récupération des emplacements des uniformes dans le shader
-    int viewEyeLoc = GetShaderLocation(shader, "viewEye");
-    int viewCenterLoc = GetShaderLocation(shader, "viewCenter");
-    int resolutionLoc = GetShaderLocation(shader, "resolution");
-    int timeLoc = GetShaderLocation(shader, "time");
-    
-    // Paramètres de résolution pour le shader
-    float resolution[2] = { (float)screenWidth, (float)screenHeight };
-    SetShaderValue(shader, resolutionLoc, resolution, SHADER_UNIFORM_VEC2);
-    
-    // Emplacement des uniformes pour les sphères et les matériaux
-    int spheresLoc = GetShaderLocation(shader, "spheres");
-    int materialsLoc = GetShaderLocation(shader, "materials");
-    int sphereCountLoc = GetShaderLocation(shader, "sphereCount");
-    int lightPosLoc = GetShaderLocation(shader, "lightPos");
-    int lightColorLoc = GetShaderLocation(shader, "lightColor");
-    int lightIntensityLoc = GetShaderLocation(shader, "lightIntensity");
-    
-    // Emplacements pour le faisceau lumineux
-    int beamDirectionLoc = GetShaderLocation(shader, "beamDirection");
-    int beamPositionLoc = GetShaderLocation(shader, "beamPosition");
-    int beamColorLoc = GetShaderLocation(shader, "beamColor");
-    int beamAngleLoc = GetShaderLocation(shader, "beamAngle");
-    int beamIntensityLoc = GetShaderLocation(shader, "beamIntensity");
-    int enableBeamLoc = GetShaderLocation(shader, "enableBeam");
-    
-    // Emplacements pour les vagues circulaires
-    int waveCenterLoc = GetShaderLocation(shader, "waveCenter");
-    int enableWavesLoc = GetShaderLocation(shader, "enableWaves");
-    int waveDurationLoc = GetShaderLocation(shader, "waveDuration");
-    int waveAmplitudeLoc = GetShaderLocation(shader, "waveAmplitude");
-    int waveStartTimeLoc = GetShaderLocation(shader, "waveStartTime");
-    int waveDecayRateLoc = GetShaderLocation(shader, "waveDecayRate");
-    
-    //pareil pour les blocs de murs
-    int blocksLoc = GetShaderLocation(shader, "blocks");
-    int materialsBlockLoc = GetShaderLocation(shader, "materials_block");
-    int blockCountLoc = GetShaderLocation(shader, "blockCount");
-    
-    // Passage du nombre de sphères au shader
-    int sphereCount = MAX_SPHERES;
-    SetShaderValue(shader, sphereCountLoc, &sphereCount, SHADER_UNIFORM_INT);
-    
-    // Passage du nombre de blocs au shader
-    int blockCount = MAX_BLOCKS;
-    SetShaderValue(shader, blockCountLoc, &blockCount, SHADER_UNIFORM_INT);
+    // Primitives et matériaux dans des texture buffers : leur nombre n'est connu
+    // qu'à l'exécution et n'est plus limité par les tableaux d'uniformes
+    SceneStorage sceneStorage;
+    InitSceneStorage(&sceneStorage);
+    for (int i = 0; i < DEFAULT_SPHERE_COUNT; i++) AddSceneSphere(&sceneStorage, spheres[i], materials[i]);
+    for (int i = 0; i < DEFAULT_BLOCK_COUNT; i++) AddSceneBlock(&sceneStorage, blocks[i], materials_block[i]);
+    if (stressSpheres > 0 || stressBlocks > 0) GenerateStressScene(&sceneStorage, stressSpheres, stressBlocks, 1234u);
+
+    // BVH des primitives : reconstruit quand des primitives sont ajoutées ou
+    // retirées, simplement réajusté (refit) quand elles bougent
+    Bvh bvh;
+    InitBvh(&bvh);
+
+    // Sources de lumière tirées selon leur puissance par l'éclairage direct
+    LightList lights;
+    InitLightList(&lights);
+
+    // Buffer uniforme des paramètres globaux de la scène
+    SceneBuffer sceneBuffer = LoadSceneBuffer();
+    SceneBlock sceneBlock = { 0 };
+
+    // Emplacements des uniformes de la passe de TAA
+    int taaResolutionLoc = GetShaderLocation(taa_shader, "resolution");
+    int taaTimeLoc = GetShaderLocation(taa_shader, "time");
+    int taaFrameLoc = GetShaderLocation(taa_shader, "frame");
+    int taaCurrentLoc = GetShaderLocation(taa_shader, "currentFrame");
+    int taaHistoryLoc = GetShaderLocation(taa_shader, "historyFrame");
+    int taaRenderScaleLoc = GetShaderLocation(taa_shader, "renderScale");
+    int taaReprojectionLoc = GetShaderLocation(taa_shader, "reprojection");
+
+    // Débruitage + TAA en une seule passe compute si OpenGL 4.3 est disponible (F6 pour comparer)
+    DenoiseTaaPass denoiseTaaPass;
+    bool useFusedPost = LoadDenoiseTaaPass(&denoiseTaaPass, "denoise_taa.comp");
+
+    // Temps GPU du raytracing et des passes de post-traitement (séparées et fusionnée)
+    GpuTimer traceTimer, denoiseTimer, taaTimer, fusedTimer;
+    LoadGpuTimer(&traceTimer);
+    LoadGpuTimer(&denoiseTimer);
+    LoadGpuTimer(&taaTimer);
+    LoadGpuTimer(&fusedTimer);
+
+    // Longueur moyenne des chemins et causes d'arrêt (relues avec quelques frames de retard)
+    PathStats pathStats;
+    LoadPathStats(&pathStats);
+
+    // Champ de vagues évalué une fois par frame, lu par raytest.fs
+    WaterField waterField;
+    LoadWaterField(&waterField, "water_field.fs");
+
+    // Pyramide min/max du champ pour le parcours hiérarchique de la surface
+    WaterBounds waterBounds;
+    LoadWaterBounds(&waterBounds, "water_bounds.fs");
+
+    // Simulation des vagues sur CPU (threads de travail, envoi asynchrone)
+    WaterSimulation waterSim;
+    LoadWaterSimulation(&waterSim);
+    if (waterSimulation) StartWaterSimulation(&waterSim);
+    float lastWaveStartTime = waveStartTime;
 
     float runTime = 0.0f;
     
@@ -206,12 +398,97 @@ int main(void) {
     //RenderTexture2D history = LoadRenderTexture(screenWidth, screenHeight);
 
     //pour le shader de denoising
-    RenderTexture2D renderNoisy = LoadRenderTexture(screenWidth, screenHeight);
-    RenderTexture2D renderNormals = LoadRenderTexture(screenWidth, screenHeight);
-    RenderTexture2D renderHistory = LoadRenderTexture(screenWidth, screenHeight);
-    RenderTexture2D denoiseTarget = LoadRenderTexture(screenWidth, screenHeight);
-    RenderTexture2D taaOutput = LoadRenderTexture(screenWidth, screenHeight);
+    // Sortie de raytest.fs : couleur bruitée + G-buffer (normale, profondeur, matériau)
+    GBuffer gbuffer = LoadGBuffer(screenWidth, screenHeight);
+
+    // Débruitage À-Trous sur plusieurs niveaux (pas 1 à 16), cibles en alternance
+    AtrousFilter atrous;
+    LoadAtrousFilter(&atrous, "denoise.fs", screenWidth, screenHeight);
+    if (atrousLevels > 0) atrous.levelCount = (atrousLevels > ATROUS_MAX_LEVELS) ? ATROUS_MAX_LEVELS : atrousLevels;
+
+    // Résolution dynamique : seule la partie renderWidth x renderHeight des cibles
+    // est tracée et débruitée, le TAA remonte à la taille de la fenêtre
+    DynamicResolution dynamicResolution;
+    InitDynamicResolution(&dynamicResolution, screenWidth, screenHeight, targetFrameMs);
+    SetDynamicResolutionEnabled(&dynamicResolution, useDynamicResolution);
+    int renderWidth = screenWidth;      // Résolution actuellement envoyée aux shaders de raytracing
+    int renderHeight = screenHeight;
+
+    // Tracé entrelacé (F9) : la reconstruction comble les pixels non tracés avant le débruitage
+    InterleavedTracing interleave;
+    LoadInterleavedTracing(&interleave, "reconstruct.fs", screenWidth, screenHeight);
+    while (interleave.count < interleaveCount && interleave.count < INTERLEAVE_MAX_COUNT) CycleInterleavedTracing(&interleave);
+
+    // Rendu progressif : accumulation HDR tant que rien ne bouge, puis arrêt du tracé
+    ProgressiveRenderer progressive;
+    LoadProgressiveRenderer(&progressive, "progressive.fs", "progressive_weights.fs", screenWidth, screenHeight, progressiveSpp);
+    bool progressiveDirty = true;               // Remise à zéro demandée pour la frame courante
+    Vector3 progressiveCamera = camera.position; // Position de la caméra à la dernière frame accumulée
+
+    // Historique en double tampon : le TAA écrit dans renderHistory[historyWrite]
+    // (sa sortie devient l'historique de la frame suivante) pendant que le
+    // débruitage et le TAA lisent renderHistory[historyRead]. On échange les
+    // deux à chaque frame au lieu de recopier la sortie dans l'historique.
+    RenderTexture2D renderHistory[2];
+    for (int i = 0; i < 2; i++) {
+        renderHistory[i] = LoadRenderTexture(screenWidth, screenHeight);
+        // Lu au point reprojeté (mouvement de caméra), donc entre deux texels
+        SetTextureFilter(renderHistory[i].texture, TEXTURE_FILTER_BILINEAR);
+        SetTextureWrap(renderHistory[i].texture, TEXTURE_WRAP_CLAMP);
+        BeginTextureMode(renderHistory[i]);
+            ClearBackground(BLACK);
+        EndTextureMode();
+    }
+    int historyRead = 0;
+    int historyWrite = 1;
+
+    // Caméra et part rendue de la dernière frame tracée : raytest.fs reprojette
+    // chaque pixel dans cette frame (gbuffer.previousNormals)
+    Matrix previousViewProjection = MatrixIdentity();
+    Vector2 previousRenderScale = { 1.0f, 1.0f };
+
+    // BLEND_CUSTOM remplace la destination au lieu de la mélanger avec l'alpha :
+    // sortie du TAA (alpha = taux de mélange de la frame suivante) et G-buffer
+    // (alpha = profondeur, pixel tracé, statistiques de chemins)
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+
+    if (benchmark || waterCheck) {
+        int exitCode = 0;
+        if (benchmark) RunSceneBenchmark(GetRaytraceShader(&raytrace), &sceneStorage, &bvh, &lights, &sceneBuffer, gbuffer.target);
+        if (waterCheck) exitCode = RunWaterCheck(&sceneBuffer, &waterField, &waterBounds);
+        UnloadRaytraceVariants(&raytrace);
+        UnloadBlueNoise(&blueNoise);
+        UnloadAtrousFilter(&atrous);
+        UnloadInterleavedTracing(&interleave);
+        UnloadProgressiveRenderer(&progressive);
+        UnloadShader(taa_shader);
+        UnloadDenoiseTaaPass(&denoiseTaaPass);
+        UnloadGpuTimer(&traceTimer);
+        UnloadGpuTimer(&denoiseTimer);
+        UnloadGpuTimer(&taaTimer);
+        UnloadGpuTimer(&fusedTimer);
+        UnloadPathStats(&pathStats);
+        UnloadWaterField(&waterField);
+        UnloadWaterBounds(&waterBounds);
+        UnloadWaterSimulation(&waterSim);
+        UnloadBvh(&bvh);
+        UnloadLightList(&lights);
+        UnloadSceneBuffer(&sceneBuffer);
+        UnloadSceneStorage(&sceneStorage);
+        UnloadRenderTexture(target);
+        UnloadGBuffer(&gbuffer);
+        UnloadRenderTexture(renderHistory[0]);
+        UnloadRenderTexture(renderHistory[1]);
+        CloseWindow();
+        return exitCode;
+    }
     
+    // Premier draw de chaque permutation (scène vide) avant la boucle : aucun
+    // changement de niveau ne déclenche ensuite de compilation différée
+    BuildSceneBlock(&sceneBlock, 0, 0, 0, NULL);
+    UploadSceneBlock(&sceneBuffer, &sceneBlock);
+    WarmUpRaytraceVariants(&raytrace, gbuffer.target);
+
     int frameCounter = 0;
 
     SetTargetFPS(600); // Limite les FPS à 60
@@ -329,6 +606,54 @@ int main(void) {
         if (IsKeyPressed(KEY_R)) {
             waveStartTime = runTime;
         }
+
+        // Passe compute fusionnée ou passes fragment séparées
+        if (IsKeyPressed(KEY_F6) && denoiseTaaPass.program != 0) useFusedPost = !useFusedPost;
+
+        // Vagues simulées ou analytiques
+        if (IsKeyPressed(KEY_F10)) {
+            waterSimulation = !waterSimulation;
+            if (waterSimulation) StartWaterSimulation(&waterSim);
+            else StopWaterSimulation(&waterSim);
+        }
+
+        // Nombre de niveaux du débruitage À-Trous
+        if (IsKeyPressed(KEY_LEFT_BRACKET) && atrous.levelCount > 1) atrous.levelCount--;
+        if (IsKeyPressed(KEY_RIGHT_BRACKET) && atrous.levelCount < ATROUS_MAX_LEVELS) atrous.levelCount++;
+
+        // Rechargement à chaud du shader de raytracing (F5) : toutes les permutations
+        // sont recompilées, les emplacements des uniformes ne sont re-résolus qu'à ce moment-là
+        if (IsKeyPressed(KEY_F5)) {
+            if (LoadRaytraceVariants(&raytrace, "raytest.fs", (float)renderWidth, (float)renderHeight)) {
+                WarmUpRaytraceVariants(&raytrace, gbuffer.target);
+                progressiveDirty = true;
+            }
+        }
+
+        // Niveau de qualité (F7) : simple échange de programme, tous sont déjà compilés
+        if (IsKeyPressed(KEY_F7)) {
+            raytrace.current = (raytrace.current + 1) % QUALITY_TIER_COUNT;
+            progressiveDirty = true;
+        }
+
+        // Rendu progressif (P) : le temps de la scène est figé tant qu'il est actif
+        if (IsKeyPressed(KEY_P)) {
+            useProgressive = !useProgressive;
+            progressiveDirty = true;
+        }
+
+        // Résolution dynamique (F8)
+        if (IsKeyPressed(KEY_F8)) SetDynamicResolutionEnabled(&dynamicResolution, !dynamicResolution.enabled);
+
+        // Tracé entrelacé (F9) : tous les pixels, damier, un pixel sur 4
+        if (IsKeyPressed(KEY_F9)) CycleInterleavedTracing(&interleave);
+
+        // Échantillonnage adaptatif du rendu progressif (M)
+        if (IsKeyPressed(KEY_M)) {
+            progressive.adaptive = !progressive.adaptive;
+            progressiveDirty = true;
+        }
+
         // La sphère émissive garde sa couleur orange fixe : {1.0f, 0.5f, 0.0f}
         // L'intensité de la lumière varie pour créer un effet vivant
         //lightIntensity = 0.5f;
@@ -344,12 +669,9 @@ int main(void) {
         //if (IsKeyDown(KEY_MINUS) && lightIntensity > 0.2f) lightIntensity -= 0.2f;
         
         // Passage des valeurs des uniformes au shader
-        float cameraPos[3] = { camera.position.x, camera.position.y, camera.position.z };
-        float cameraTarget[3] = { 0.0f, 0.0f, 0.0f }; // On regarde toujours l'origine
+        Vector3 cameraTarget = { 0.0f, 0.0f, 0.0f }; // On regarde toujours l'origine
         
-        SetShaderValue(shader, viewEyeLoc, cameraPos, SHADER_UNIFORM_VEC3);
-        SetShaderValue(shader, viewCenterLoc, cameraTarget, SHADER_UNIFORM_VEC3);
-        SetShaderValue(shader, timeLoc, &runTime, SHADER_UNIFORM_FLOAT);
+        SetSceneCamera(GetRaytraceUniforms(&raytrace), camera.position, cameraTarget);
         // Animation de la sphère[0] pour simuler la chute puis la flottabilité sur l'eau
         static float sphereVelocity = 0.0f;
         static bool goingDown = true;
@@ -415,6 +737,10 @@ int main(void) {
                 // Quand elle atteint la surface, appliquer un freinage fort
                 if (spheres[0].position.y >= waterSurface) {
                     spheres[0].position.y = waterSurface;
+                    // Chaque remontée est un nouvel impact pour la simulation
+                    float strength = fminf(fabsf(sphereVelocity)/floatStrength, 1.0f);
+                    AddWaterImpulse(&waterSim, spheres[0].position.x, spheres[0].position.z, waveAmplitude*strength);
+                    AddWaveSource(&waveSources, spheres[0].position.x, spheres[0].position.z, runTime, strength);
                     
                     // Amortissement très fort près de la fin pour stabiliser à la surface
                     float endDamping = damping * (0.3f + progressiveDamping * 0.2f); // Devient très faible
@@ -436,202 +762,190 @@ int main(void) {
             spheres[0].position.y = waterSurface;
             sphereVelocity = 0.0f;
         }
-        // Envoi des données des sphères et des matériaux au shader
-        // Note: Ces structures doivent être correctement alignées pour le GPU
-        for (int i = 0; i < MAX_SPHERES; i++) {
-            // Format vec4 pour chaque sphère (position + rayon)
-            float sphereData[4] = { 
-                spheres[i].position.x, 
-                spheres[i].position.y, 
-                spheres[i].position.z, 
-                spheres[i].radius 
-            };
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("spheres[%d]", i)), 
-                           sphereData, SHADER_UNIFORM_VEC4);
-                           
-            // Transmission du matériau
-            // Attention: ceci est une approche simplifiée, l'alignement peut poser problème
-            // Pour un code plus robuste, considérer l'utilisation d'UBO/SSBO si disponible
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("materials[%d].type", i)), 
-                          &materials[i].type, SHADER_UNIFORM_INT);
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("materials[%d].roughness", i)), 
-                          &materials[i].roughness, SHADER_UNIFORM_FLOAT);
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("materials[%d].ior", i)), 
-                          &materials[i].ior, SHADER_UNIFORM_FLOAT);
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("materials[%d].albedo", i)), 
-                          &materials[i].albedo, SHADER_UNIFORM_VEC3);
-        }
-        // Envoi des données des blocs et de leurs matériaux au shader
-        for (int i = 0; i < MAX_BLOCKS; i++) {
-            // Format vec4 pour chaque bloc (position + taille)
-            float blockPos[3] = {
-        blocks[i].position.x, 
-        blocks[i].position.y, 
-        blocks[i].position.z
-    };
-    SetShaderValue(shader, GetShaderLocation(shader, TextFormat("blocks[%d]", i)),
-                   blockPos, SHADER_UNIFORM_VEC3);
-    
-    // Transmettez la taille séparément
-    float blockSize[3] = {
-        blocks[i].size.x,
-        blocks[i].size.y,
-        blocks[i].size.z
-    };
-    SetShaderValue(shader, GetShaderLocation(shader, TextFormat("blockSizes[%d]", i)),
-                   blockSize, SHADER_UNIFORM_VEC3);
-            // Transmission du matériau du bloc
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("materials_block[%d].type", i)),
-                          &materials_block[i].type, SHADER_UNIFORM_INT);
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("materials_block[%d].roughness", i)),
-                            &materials_block[i].roughness, SHADER_UNIFORM_FLOAT);
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("materials_block[%d].ior", i)),
-                            &materials_block[i].ior, SHADER_UNIFORM_FLOAT);
-            SetShaderValue(shader, GetShaderLocation(shader, TextFormat("materials_block[%d].albedo", i)),
-                            &materials_block[i].albedo, SHADER_UNIFORM_VEC3);
+        // Tout (re)démarrage des vagues est un impact au centre des ondulations
+        if (waveStartTime != lastWaveStartTime) {
+            AddWaterImpulse(&waterSim, waveCenter.x, waveCenter.z, waveAmplitude);
+            AddWaveSource(&waveSources, waveCenter.x, waveCenter.z, waveStartTime, 1.0f);
+            lastWaveStartTime = waveStartTime;
         }
-        
-        // Mise à jour de la position de la lumière
-        SetShaderValue(shader, lightPosLoc, &lightPos, SHADER_UNIFORM_VEC3);
-        SetShaderValue(shader, lightColorLoc, &lightColor, SHADER_UNIFORM_VEC3);
-        SetShaderValue(shader, lightIntensityLoc, &lightIntensity, SHADER_UNIFORM_FLOAT);
-        
-        // Mise à jour des paramètres du faisceau
-        SetShaderValue(shader, beamDirectionLoc, &beamDirection, SHADER_UNIFORM_VEC3);
-        SetShaderValue(shader, beamPositionLoc, &beamPosition, SHADER_ATTRIB_VEC3);
-        SetShaderValue(shader, beamColorLoc, &beamColor, SHADER_ATTRIB_VEC3);
-        SetShaderValue(shader, beamAngleLoc, &beamAngle, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(shader, beamIntensityLoc, &beamIntensity, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(shader, enableBeamLoc, &enableBeam, SHADER_UNIFORM_INT);
-        
-        // Mise à jour des paramètres des vagues
-        SetShaderValue(shader, waveCenterLoc, &waveCenter, SHADER_UNIFORM_VEC3);
-        SetShaderValue(shader, enableWavesLoc, &enableWaves, SHADER_UNIFORM_INT);
-        SetShaderValue(shader, waveDurationLoc, &waveDuration, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(shader, waveAmplitudeLoc, &waveAmplitude, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(shader, waveStartTimeLoc, &waveStartTime, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(shader, waveDecayRateLoc, &waveDecayRate, SHADER_UNIFORM_FLOAT);
-        
-        //liaison entre les textures et les shaders
-        SetShaderValueTexture(denoise_shader, GetShaderLocation(denoise_shader, "renderNoisy"), renderNoisy.texture);
-        SetShaderValueTexture(denoise_shader, GetShaderLocation(denoise_shader, "renderNormals"), renderNormals.texture);
-        SetShaderValueTexture(denoise_shader, GetShaderLocation(denoise_shader, "renderHistory"), renderHistory.texture);
+        CullWaveSources(&waveSources, runTime, waveAmplitude, waveDuration, waveDecayRate);
+        SetWaterSimulationDecay(&waterSim, waveDecayRate);
 
+        // Envoi de la scène : primitives (texture buffers) puis paramètres globaux
+        // (UBO). Seules les plages modifiées depuis la frame précédente partent.
+        SetSceneSphere(&sceneStorage, 0, spheres[0]);
+        unsigned int sceneUploadBytes = UploadSceneStorage(&sceneStorage);
+        UpdateBvh(&bvh, &sceneStorage);
+        sceneUploadBytes += UploadBvh(&bvh);
+        UpdateLightList(&lights, &sceneStorage);
+        sceneUploadBytes += UploadLightList(&lights);
+        BuildSceneBlock(&sceneBlock, (int)sceneStorage.spheres.size(), (int)sceneStorage.blocks.size(), bvh.nodeCount, &lights);
+        sceneUploadBytes += UploadSceneBlock(&sceneBuffer, &sceneBlock);
+        
         //pour le taa shader
-        SetShaderValue(taa_shader, GetShaderLocation(taa_shader, "resolution"), resolution, SHADER_UNIFORM_VEC2);
-        SetShaderValue(taa_shader, GetShaderLocation(taa_shader, "time"), &runTime, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(taa_shader, GetShaderLocation(taa_shader, "frame"), &frameCounter, SHADER_UNIFORM_INT);
-
-        SetShaderValueTexture(taa_shader, GetShaderLocation(taa_shader, "currentFrame"), denoiseTarget.texture);
-        SetShaderValueTexture(taa_shader, GetShaderLocation(taa_shader, "historyFrame"), renderHistory.texture);
+        SetShaderValue(taa_shader, taaResolutionLoc, resolution, SHADER_UNIFORM_VEC2);
+        SetShaderValue(taa_shader, taaTimeLoc, &runTime, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(taa_shader, taaFrameLoc, &frameCounter, SHADER_UNIFORM_INT);
+        SetShaderValueTexture(taa_shader, taaHistoryLoc, renderHistory[historyRead].texture);
 
 
         // Vérification si la fenêtre est redimensionnée
         if (IsWindowResized()) {
             resolution[0] = (float)GetScreenWidth();
             resolution[1] = (float)GetScreenHeight();
-            SetShaderValue(shader, resolutionLoc, resolution, SHADER_UNIFORM_VEC2);
+            renderWidth = 0;    // Résolution du raytracing renvoyée plus bas
+            progressiveDirty = true;
         }
+
+        // Résolution interne de la frame, d'après le temps GPU mesuré (raytracing +
+        // post-traitement). Le rendu progressif reste toujours à pleine résolution.
+        ReadGpuTimer(&traceTimer, false);
+        ReadGpuTimer(&denoiseTimer, false);
+        ReadGpuTimer(&taaTimer, false);
+        ReadGpuTimer(&fusedTimer, false);
+        ReadPathStats(&pathStats);
+        if (!useProgressive) {
+            float postMs = useFusedPost ? fusedTimer.lastMs : denoiseTimer.lastMs + taaTimer.lastMs;
+            UpdateDynamicResolution(&dynamicResolution, traceTimer.lastMs + postMs);
+        }
+        int frameWidth = useProgressive ? screenWidth : dynamicResolution.width;
+        int frameHeight = useProgressive ? screenHeight : dynamicResolution.height;
+        if (frameWidth != renderWidth || frameHeight != renderHeight) {
+            renderWidth = frameWidth;
+            renderHeight = frameHeight;
+            SetRaytraceResolution(&raytrace, (float)renderWidth, (float)renderHeight);
+        }
+        float renderScale[2] = { (float)renderWidth/(float)screenWidth, (float)renderHeight/(float)screenHeight };
+        SetShaderValue(taa_shader, taaRenderScaleLoc, renderScale, SHADER_UNIFORM_VEC2);
+
+        // Rendu progressif : repart de zéro à tout changement de caméra ou de scène
+        // (la moindre donnée envoyée au GPU), sinon continue l'accumulation
+        if (useProgressive) {
+            if (!Vector3Equals(camera.position, progressiveCamera) || sceneUploadBytes > 0) progressiveDirty = true;
+            if (progressiveDirty) ResetProgressiveRenderer(&progressive, runTime);
+        }
+        progressiveDirty = false;
+        progressiveCamera = camera.position;
+
+        // Temps de la scène (figé en mode progressif) et graine du bruit, propre à chaque frame
+        const SceneUniforms *raytraceUniforms = GetRaytraceUniforms(&raytrace);
+        SetSceneTime(raytraceUniforms, useProgressive ? progressive.sceneTime : runTime);
+        // Vagues de la frame : état simulé le plus récent (figé en mode progressif)
+        // ou champ analytique évalué pour le temps de la scène
+        if (waterSimulation) {
+            bool uploaded = !useProgressive && (UploadWaterSimulation(&waterSim) > 0);
+            BindWaterFieldTexture(waterSim.texture);
+            SetSceneWaterField(raytraceUniforms, waterSim.origin, waterSim.size);
+            UpdateWaterBounds(&waterBounds, waterSim.texture, uploaded);
+        } else {
+            bool updated = UpdateWaterField(&waterField, useProgressive ? progressive.sceneTime : runTime, sceneBlock.waveSources, sceneBlock.waveSourceCount, sceneUploadBytes > 0);
+            BindWaterFieldTexture(waterField.target.texture);
+            SetSceneWaterField(raytraceUniforms, waterField.origin, waterField.size);
+            UpdateWaterBounds(&waterBounds, waterField.target.texture, updated);
+        }
+        SetSceneFrameSeed(raytraceUniforms, useProgressive ? (float)(progressive.frameCount + 1)*1.618f : runTime);
+        SetSceneFrameIndex(raytraceUniforms, useProgressive ? progressive.frameCount : frameCounter);
+        SetSceneLinearOutput(raytraceUniforms, useProgressive);
+        // Le rendu progressif trace toujours tous les pixels
+        if (!useProgressive) AdvanceInterleavedTracing(&interleave);
+        SetSceneInterleave(raytraceUniforms, useProgressive ? 1 : interleave.count, interleave.phase);
         
-        // Dessin
-        BeginTextureMode(renderNoisy);       // Enable drawing to texture
-                          // End drawing to texture (now we have a texture available for next passes)
+        if (useProgressive) {
+            // Plus aucun tracé une fois l'objectif atteint : l'image résolue est réaffichée
+            if (!IsProgressiveConverged(&progressive)) {
+                AccumulateProgressiveFrame(&progressive, GetRaytraceUniforms(&raytrace), GetQualityTier(raytrace.current)->samples);
+            }
+        } else {
+            // Dessin (le G-buffer de la frame précédente est conservé pour la reprojection)
+            SwapGBufferHistory(&gbuffer);
+            BeginGpuTimer(&traceTimer);
+            BeginTextureMode(gbuffer.target);    // Enable drawing to texture (couleur + G-buffer)
+                ClearGBufferPathStats();
+                              // End drawing to texture (now we have a texture available for next passes)
         
-        //BeginDrawing();
-        //BeginDrawing(); // Start 3d mode drawing
-            //ClearBackground(BLACK);
+            //BeginDrawing();
+            //BeginDrawing(); // Start 3d mode drawing
+                //ClearBackground(BLACK);
             
-            // On dessine simplement un rectangle plein écran blanc,
-            // l'image est générée dans le shader de raytracing
-            BeginShaderMode(shader);
-                DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), WHITE);
-            EndShaderMode();
-            //EndDrawing();
+                // On dessine simplement un rectangle blanc couvrant la partie rendue
+                // (coin bas-gauche en coordonnées GL), l'image est générée dans le
+                // shader de raytracing
+                // Sans mélange : l'alpha des attachements du G-buffer contient des
+                // données (profondeur, pixel tracé...), pas une opacité
+                BeginBlendMode(BLEND_CUSTOM);
+                BeginShaderMode(GetRaytraceShader(&raytrace));
+                    // Échantillonnage uniforme : AccumulateProgressiveFrame active le mode
+                    // adaptatif sur le même programme, il y resterait après la sortie du
+                    // mode progressif
+                    SetSceneAdaptiveSampling(raytraceUniforms, false, progressive.weights.texture, 0.0f);
+                    SetSceneReprojection(raytraceUniforms, previousViewProjection, gbuffer.previousNormals, previousRenderScale);
+                    DrawRectangle(0, screenHeight - renderHeight, renderWidth, renderHeight, WHITE);
+                EndShaderMode();
+                EndBlendMode();
+                //EndDrawing();
             
-        //EndDrawing();
+            //EndDrawing();
         
-        EndTextureMode();
+            EndTextureMode();
+            CapturePathStats(&pathStats, gbuffer.pathStats);
 
+            // Pixels non tracés cette frame : historique reprojeté ou voisins tracés
+            Texture2D historyTexture = renderHistory[historyRead].texture;
+            Texture2D traced = gbuffer.target.texture;
+            if (interleave.count > 1) traced = ReconstructInterleavedFrame(&interleave, traced, &gbuffer, historyTexture, renderWidth, renderHeight);
+            EndGpuTimer(&traceTimer);
+            previousViewProjection = GetSceneViewProjection(camera.position, cameraTarget, (float)renderWidth/(float)renderHeight);
+            previousRenderScale = (Vector2){ renderScale[0], renderScale[1] };
 
-            BeginTextureMode(denoiseTarget); // ← on dessine dans denoiseTarget (frame courante débruitée)
-                BeginShaderMode(denoise_shader);
-                    // Uniformes
-                    float resolution[2] = { (float)GetScreenWidth(), (float)GetScreenHeight() };
-                    SetShaderValue(denoise_shader, GetShaderLocation(denoise_shader, "resolution"), resolution, SHADER_UNIFORM_VEC2);
-
-                    SetShaderValue(denoise_shader, GetShaderLocation(denoise_shader, "time"), &runTime, SHADER_UNIFORM_FLOAT);
-                    SetShaderValue(denoise_shader, GetShaderLocation(denoise_shader, "frame"), &frameCounter, SHADER_UNIFORM_INT);
-
-                    float denoiseStrength = 1.0f;
-                    SetShaderValue(denoise_shader, GetShaderLocation(denoise_shader, "u_denoiseStrength"), &denoiseStrength, SHADER_UNIFORM_FLOAT);
-
-                    // Textures (attention aux noms !)
-                    SetShaderValueTexture(denoise_shader, GetShaderLocation(denoise_shader, "renderNoisy"), renderNoisy.texture);
-                    SetShaderValueTexture(denoise_shader, GetShaderLocation(denoise_shader, "renderNormals"), renderNormals.texture);
-                    SetShaderValueTexture(denoise_shader, GetShaderLocation(denoise_shader, "renderHistory"), renderHistory.texture);
-
-                    // Dessiner un quad plein écran pour appliquer le shader
-                    DrawTexturePro(
-                        renderNoisy.texture,                       // source texture (image bruitée)
-                        (Rectangle){ 0, 0, (float)screenWidth, -(float)screenHeight },
-                        (Rectangle){ 0, 0, (float)screenWidth, (float)screenHeight },
-                        (Vector2){ 0, 0 },
-                        0.0f,
-                        WHITE
-                    );
-                EndShaderMode();
-            EndTextureMode();
+            if (useFusedPost) {
+                // Niveaux À-Trous de pas 16 à 2, puis pas 1 + TAA en une passe,
+                // écrite directement dans l'historique
+                BeginGpuTimer(&fusedTimer);
+                Texture2D filtered = ApplyAtrousFilter(&atrous, traced, &gbuffer, historyTexture, renderWidth, renderHeight, false);
+                DispatchDenoiseTaaPass(&denoiseTaaPass, &atrous.levels[0], filtered, gbuffer.normals, gbuffer.material,
+                                       gbuffer.reprojection, historyTexture, renderHistory[historyWrite].texture, renderWidth, renderHeight);
+                EndGpuTimer(&fusedTimer);
+            } else {
+                // Chaîne À-Trous complète (pas 16 à 1)
+                BeginGpuTimer(&denoiseTimer);
+                Texture2D denoised = ApplyAtrousFilter(&atrous, traced, &gbuffer, historyTexture, renderWidth, renderHeight, true);
+                EndGpuTimer(&denoiseTimer);
 
-// Application du TAA à la texture de sortie finale
-BeginTextureMode(taaOutput);  // Capture le résultat du TAA dans taaOutput
-    BeginShaderMode(taa_shader);
-        // Passer la texture courante (débruitée) et la frame précédente
-        SetShaderValueTexture(taa_shader, GetShaderLocation(taa_shader, "currentFrame"), denoiseTarget.texture);
-        SetShaderValueTexture(taa_shader, GetShaderLocation(taa_shader, "historyFrame"), renderHistory.texture);
-
-        // Uniformes nécessaires
-        SetShaderValue(taa_shader, GetShaderLocation(taa_shader, "time"), &runTime, SHADER_UNIFORM_FLOAT);
-        SetShaderValue(taa_shader, GetShaderLocation(taa_shader, "frame"), &frameCounter, SHADER_UNIFORM_INT);
-
-        DrawTexturePro(
-            denoiseTarget.texture,
-            (Rectangle){ 0, 0, (float)screenWidth, -(float)screenHeight },
-            (Rectangle){ 0, 0, (float)screenWidth, (float)screenHeight },
-            (Vector2){ 0, 0 },
-            0.0f,
-            WHITE
-        );
-    EndShaderMode();
-EndTextureMode();
-//pour enlever les artefacts de la frame précédente
-if (frameCounter % 3 == 0) {
-    BeginTextureMode(renderHistory);
-        // On écrase totalement l'historique avec l'image courante (nettoyée)
-        DrawTextureRec(
-            denoiseTarget.texture,
-            (Rectangle){ 0, 0, (float)screenWidth, -(float)screenHeight },
-            (Vector2){ 0, 0 },
-            WHITE
-        );
-    EndTextureMode();
-}
+    // Application du TAA : le résultat est écrit directement dans l'historique de la frame suivante
+    BeginGpuTimer(&taaTimer);
+    BeginTextureMode(renderHistory[historyWrite]);
+        BeginBlendMode(BLEND_CUSTOM);
+        BeginShaderMode(taa_shader);
+            // Passer la texture courante (débruitée) et la frame précédente
+            SetShaderValueTexture(taa_shader, taaCurrentLoc, denoised);
+            SetShaderValueTexture(taa_shader, taaHistoryLoc, historyTexture);
+            SetShaderValueTexture(taa_shader, taaReprojectionLoc, gbuffer.reprojection);
 
-            //pour la derniere image
-            BeginTextureMode(renderHistory);
-                DrawTextureRec(
-                        taaOutput.texture,
-                        (Rectangle){ 0, 0, (float)screenWidth, -(float)screenHeight },
-                        (Vector2){ 0, 0 },
-                        WHITE
-                    );
-                EndTextureMode();
+            // Uniformes nécessaires
+            SetShaderValue(taa_shader, taaTimeLoc, &runTime, SHADER_UNIFORM_FLOAT);
+            SetShaderValue(taa_shader, taaFrameLoc, &frameCounter, SHADER_UNIFORM_INT);
+
+            DrawTexturePro(
+                denoised,
+                (Rectangle){ 0, 0, (float)screenWidth, -(float)screenHeight },
+                (Rectangle){ 0, 0, (float)screenWidth, (float)screenHeight },
+                (Vector2){ 0, 0 },
+                0.0f,
+                WHITE
+            );
+        EndShaderMode();
+        EndBlendMode();
+    EndTextureMode();
+    EndGpuTimer(&taaTimer);
+            }
+        }
                 
 BeginDrawing();
     //ClearBackground(BLACK); //faut pas mettre ça sinon ça assombrit l'image
 
-    // Dessiner le résultat du TAA
+    // Dessiner le résultat du TAA (ou du rendu progressif)
     DrawTextureRec(
-        taaOutput.texture,
+        useProgressive ? progressive.resolved.texture : renderHistory[historyWrite].texture,
         (Rectangle){ 0, 0, (float)screenWidth, -(float)screenHeight },
         (Vector2){ 0, 0 },
         WHITE
@@ -642,8 +956,42 @@ BeginDrawing();
     DrawText(TextFormat("Light Intensity: %.1f", lightIntensity), 10, 30, 20, WHITE);
     DrawText(TextFormat("Beam: %s | Angle: %.2f | Intensity: %.1f", 
              enableBeam ? "ON" : "OFF", beamAngle, beamIntensity), 10, 50, 20, WHITE);
-    DrawText(TextFormat("Waves: %s | Amp: %.2f | Dur: %.1fs | Decay: %.0f%%", 
-             enableWaves ? "ON" : "OFF", waveAmplitude, waveDuration, waveDecayRate * 100), 10, 70, 20, WHITE);
+    DrawText(TextFormat("Waves: %s | Amp: %.2f | Dur: %.1fs | Decay: %.0f%% | sources %i/%i", 
+             enableWaves ? "ON" : "OFF", waveAmplitude, waveDuration, waveDecayRate * 100, waveSources.count, WAVE_SOURCE_MAX), 10, 70, 20, WHITE);
+    
+    const QualityTierDesc *tier = GetQualityTier(raytrace.current);
+    DrawText(TextFormat("Quality: %s (%i spp, %i bounces) | F7", tier->name, tier->samples, tier->bounces), 10, 170, 20, WHITE);
+    if (useProgressive) {
+        DrawText(TextFormat("Progressive: %i / %i spp%s | P | sampling: %s (M)", progressive.sampleCount, progressive.targetSamples,
+                 IsProgressiveConverged(&progressive) ? " (converged)" : "", progressive.adaptive ? "adaptive" : "uniform"), 10, 190, 20, WHITE);
+    } else {
+        float frameGpuMs = traceTimer.averageMs + (useFusedPost ? fusedTimer.averageMs : denoiseTimer.averageMs + taaTimer.averageMs);
+        DrawText(TextFormat("Resolution: %ix%i (%.0f%%) | GPU %.2f ms / %.1f ms | dynamic: %s (F8) | traced 1/%i (F9)", renderWidth, renderHeight,
+                 dynamicResolution.scale*100.0f, frameGpuMs, dynamicResolution.targetMs,
+                 dynamicResolution.enabled ? "ON" : "OFF", interleave.count), 10, 190, 20, WHITE);
+        DrawText(TextFormat("Paths: %.2f segments | roulette %.0f%% | depth limit %.0f%%", pathStats.meanLength,
+                 pathStats.rouletteRate*100.0f, pathStats.depthRate*100.0f), 10, 210, 20, WHITE);
+    }
+    DrawText(TextFormat("Scene upload: %u bytes/frame | %i spheres, %i blocks, %i lights", sceneUploadBytes,
+             (int)sceneStorage.spheres.size(), (int)sceneStorage.blocks.size(), GetLightCount(&lights)), 10, 110, 20, WHITE);
+    DrawText(TextFormat("BVH: %i nodes | build %.2f ms | SAH %.1f / %.1f | refit %i nodes | %i rebuilds%s", bvh.nodeCount, bvh.buildMs,
+             GetBvhSahCost(&bvh), bvh.builtSahCost, bvh.refitCount, bvh.rebuildCount, (bvh.rebuild != NULL) ? " (rebuilding)" : ""), 10, 130, 20, WHITE);
+    if (waterSimulation) {
+        DrawText(TextFormat("Water: simulated %ix%i | %i threads | step %.2f ms @ %i Hz | F10", WATER_SIM_SIZE, WATER_SIM_SIZE,
+                 waterSim.threadCount, waterSim.stepMs, WATER_SIM_RATE), 10, 230, 20, WHITE);
+    } else {
+        DrawText("Water: analytic | F10", 10, 230, 20, WHITE);
+    }
+
+    // Comparaison des temps GPU du post-traitement (mesures lues en début de frame)
+    if (denoiseTaaPass.program != 0) {
+        DrawText(TextFormat("Post GPU (%i levels): denoise %.2f + TAA %.2f = %.2f ms | fused %.2f ms | F6: %s", atrous.levelCount,
+                 denoiseTimer.averageMs, taaTimer.averageMs, denoiseTimer.averageMs + taaTimer.averageMs, fusedTimer.averageMs,
+                 useFusedPost ? "fused" : "separate"), 10, 150, 20, WHITE);
+    } else {
+        DrawText(TextFormat("Post GPU (%i levels): denoise %.2f + TAA %.2f = %.2f ms | fused N/A (GL 4.3)", atrous.levelCount,
+                 denoiseTimer.averageMs, taaTimer.averageMs, denoiseTimer.averageMs + taaTimer.averageMs), 10, 150, 20, WHITE);
+    }
     
     // Calculer le temps restant pour les vagues
     float elapsedTime = runTime - waveStartTime;
@@ -668,22 +1016,41 @@ BeginDrawing();
     DrawText("  V - Toggle waves | R - Restart waves | Ctrl + WASD - Move center", 10, GetScreenHeight() - 70, 20, WHITE);
     DrawText("  Alt + Up/Down - Wave amplitude | Alt + Left/Right - Duration", 10, GetScreenHeight() - 50, 20, WHITE);
     DrawText("  Right Alt + Up/Down - Decay rate (persistence)", 10, GetScreenHeight() - 30, 20, WHITE);
-    DrawText("  Shift + WASD/ZX - Beam direction", 10, GetScreenHeight() - 10, 20, WHITE);
+    DrawText("  Shift + WASD/ZX - Beam direction | F5 - Reload shader | F6 - Fused post | F7 - Quality | F8 - Dynamic res | F9 - Interleave | F10 - Water sim | P/M - Progressive/adaptive | [ ] - Denoise levels", 10, GetScreenHeight() - 10, 20, WHITE);
 EndDrawing();
 
+        // La sortie de cette frame devient l'historique lu par la suivante
+        historyRead = historyWrite;
+        historyWrite = 1 - historyWrite;
+
         frameCounter++;
 
     }
     
     // Nettoyage
-    UnloadShader(shader);
-    UnloadShader(denoise_shader);
+    UnloadRaytraceVariants(&raytrace);
+    UnloadBlueNoise(&blueNoise);
+    UnloadSceneBuffer(&sceneBuffer);
+    UnloadSceneStorage(&sceneStorage);
+    UnloadBvh(&bvh);
+    UnloadLightList(&lights);
+    UnloadAtrousFilter(&atrous);
+    UnloadInterleavedTracing(&interleave);
+    UnloadProgressiveRenderer(&progressive);
     UnloadShader(taa_shader);
+    UnloadDenoiseTaaPass(&denoiseTaaPass);
+    UnloadGpuTimer(&traceTimer);
+    UnloadGpuTimer(&denoiseTimer);
+    UnloadGpuTimer(&taaTimer);
+    UnloadGpuTimer(&fusedTimer);
+    UnloadPathStats(&pathStats);
+    UnloadWaterField(&waterField);
+    UnloadWaterBounds(&waterBounds);
+    UnloadWaterSimulation(&waterSim);
     UnloadRenderTexture(target); // Unload render texture
-    UnloadRenderTexture(renderNoisy);
-    UnloadRenderTexture(renderNormals);
-    UnloadRenderTexture(renderHistory);
-    UnloadRenderTexture(denoiseTarget);
+    UnloadGBuffer(&gbuffer);
+    UnloadRenderTexture(renderHistory[0]);
+    UnloadRenderTexture(renderHistory[1]);
     CloseWindow();
     
     return 0;
@@ -0,0 +1,68 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "path_stats.h"
+#include <math.h>
+
+void LoadPathStats(PathStats *stats) {
+    glGenBuffers(PATH_STATS_BUFFER_COUNT, stats->buffers);
+    for (int i = 0; i < PATH_STATS_BUFFER_COUNT; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, stats->buffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4*sizeof(float), NULL, GL_STREAM_READ);
+        stats->fences[i] = NULL;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    stats->current = 0;
+    stats->meanLength = 0.0f;
+    stats->rouletteRate = 0.0f;
+    stats->depthRate = 0.0f;
+}
+
+void UnloadPathStats(PathStats *stats) {
+    for (int i = 0; i < PATH_STATS_BUFFER_COUNT; i++) {
+        if (stats->fences[i] != NULL) glDeleteSync((GLsync)stats->fences[i]);
+    }
+    glDeleteBuffers(PATH_STATS_BUFFER_COUNT, stats->buffers);
+}
+
+void CapturePathStats(PathStats *stats, Texture2D pathStats) {
+    // Toutes les lectures sont en attente (GPU très en retard) : capture sautée
+    if (stats->fences[stats->current] != NULL) return;
+
+    // Dernier niveau (1x1) : moyenne de chaque canal sur toute la texture. Les
+    // rapports à l'alpha (part des pixels tracés) n'en dépendent pas.
+    int topLevel = (int)floorf(log2f((float)((pathStats.width > pathStats.height) ? pathStats.width : pathStats.height)));
+    glBindTexture(GL_TEXTURE_2D, pathStats.id);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, stats->buffers[stats->current]);
+    glGetTexImage(GL_TEXTURE_2D, topLevel, GL_RGBA, GL_FLOAT, (void *)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    stats->fences[stats->current] = (void *)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    stats->current = (stats->current + 1) % PATH_STATS_BUFFER_COUNT;
+}
+
+void ReadPathStats(PathStats *stats) {
+    // Parcours des captures de la plus ancienne à la plus récente
+    for (int k = 0; k < PATH_STATS_BUFFER_COUNT; k++) {
+        int i = (stats->current + k) % PATH_STATS_BUFFER_COUNT;
+        if (stats->fences[i] == NULL) continue;
+
+        GLenum status = glClientWaitSync((GLsync)stats->fences[i], 0, 0);
+        if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED)) break;  // Les suivantes ne sont pas prêtes non plus
+        glDeleteSync((GLsync)stats->fences[i]);
+        stats->fences[i] = NULL;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, stats->buffers[i]);
+        const float *mean = (const float *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4*sizeof(float), GL_MAP_READ_BIT);
+        if ((mean != NULL) && (mean[3] > 0.0f)) {
+            // r : longueur, g : arrêts par roulette, b : arrêts par profondeur, a : pixels tracés
+            stats->meanLength = mean[0]/mean[3];
+            stats->rouletteRate = mean[1]/mean[3];
+            stats->depthRate = mean[2]/mean[3];
+        }
+        if (mean != NULL) glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef PATH_STATS_H
+#define PATH_STATS_H
+
+#include "raylib.h"
+
+// Nombre de lectures en vol : comme pour GpuTimer, le résultat a quelques
+// frames de retard mais sa lecture ne bloque jamais le CPU
+#define PATH_STATS_BUFFER_COUNT 4
+
+// Statistiques de longueur des chemins de la passe de raytracing. raytest.fs
+// écrit par pixel (attachement 4 du G-buffer) la longueur moyenne des chemins et
+// la part de chaque cause d'arrêt, avec un alpha de 1 si le pixel est tracé ; la
+// moyenne sur l'image est obtenue par les mipmaps puis relue de façon
+// asynchrone (pixel buffer + fence).
+typedef struct {
+    unsigned int buffers[PATH_STATS_BUFFER_COUNT];
+    void *fences[PATH_STATS_BUFFER_COUNT];  // GLsync, NULL si aucune lecture en attente
+    int current;            // Buffer utilisé par la prochaine capture
+
+    float meanLength;       // Segments tracés par chemin
+    float rouletteRate;     // Part des chemins arrêtés par la roulette russe
+    float depthRate;        // Part des chemins arrêtés par leur profondeur maximale
+} PathStats;
+
+void LoadPathStats(PathStats *stats);
+void UnloadPathStats(PathStats *stats);
+
+// Réduction de la texture de statistiques et lecture différée de son dernier
+// niveau de mipmap (après la passe de raytracing)
+void CapturePathStats(PathStats *stats, Texture2D pathStats);
+
+// Récupère les captures terminées sans attendre le GPU
+void ReadPathStats(PathStats *stats);
+
+#endif // PATH_STATS_H
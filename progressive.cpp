@@ -0,0 +1,141 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "progressive.h"
+#include "rlgl.h"
+#include <stddef.h>
+
+static Texture2D LoadFloatTexture(int width, int height, int format) {
+    Texture2D texture = { 0 };
+    texture.id = rlLoadTexture(NULL, width, height, format, 1);
+    texture.width = width;
+    texture.height = height;
+    texture.mipmaps = 1;
+    texture.format = format;
+    return texture;
+}
+
+// Cibles en flottants 32 bits : la somme de milliers de frames ne perd pas les
+// petites contributions
+static RenderTexture2D LoadFloatRenderTexture(int width, int height, int format) {
+    RenderTexture2D target = { 0 };
+    target.id = rlLoadFramebuffer();
+    target.texture = LoadFloatTexture(width, height, format);
+
+    rlFramebufferAttach(target.id, target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+    if (!rlFramebufferComplete(target.id)) TraceLog(LOG_WARNING, "PROGRESSIVE: Framebuffer incomplet");
+    return target;
+}
+
+void LoadProgressiveRenderer(ProgressiveRenderer *progressive, const char *resolveFileName, const char *weightsFileName,
+                             int width, int height, int targetSamples) {
+    progressive->accumulation = LoadFloatRenderTexture(width, height, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32);
+    progressive->moments = LoadFloatTexture(width, height, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32);
+    rlFramebufferAttach(progressive->accumulation.id, progressive->moments.id, RL_ATTACHMENT_COLOR_CHANNEL1, RL_ATTACHMENT_TEXTURE2D, 0);
+    rlEnableFramebuffer(progressive->accumulation.id);
+    rlActiveDrawBuffers(2);
+    rlDisableFramebuffer();
+    if (!rlFramebufferComplete(progressive->accumulation.id)) TraceLog(LOG_WARNING, "PROGRESSIVE: Framebuffer incomplet");
+
+    // Le poids moyen est lu dans le dernier niveau de mipmap (textureLod) ; le
+    // second canal recopie le nombre d'échantillons accumulés du pixel
+    progressive->weights = LoadFloatRenderTexture(width, height, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32);
+    glBindTexture(GL_TEXTURE_2D, progressive->weights.texture.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    progressive->resolved = LoadRenderTexture(width, height);
+
+    progressive->resolveShader = LoadShader(0, resolveFileName);
+    progressive->accumulationLoc = GetShaderLocation(progressive->resolveShader, "accumulation");
+    progressive->resolutionLoc = GetShaderLocation(progressive->resolveShader, "resolution");
+
+    progressive->weightsShader = LoadShader(0, weightsFileName);
+    progressive->weightsAccumulationLoc = GetShaderLocation(progressive->weightsShader, "accumulation");
+    progressive->weightsMomentsLoc = GetShaderLocation(progressive->weightsShader, "moments");
+
+    progressive->adaptive = true;
+    progressive->targetSamples = targetSamples;
+    ResetProgressiveRenderer(progressive, 0.0f);
+}
+
+void UnloadProgressiveRenderer(ProgressiveRenderer *progressive) {
+    UnloadShader(progressive->resolveShader);
+    UnloadShader(progressive->weightsShader);
+    UnloadRenderTexture(progressive->accumulation);
+    UnloadTexture(progressive->moments);
+    UnloadRenderTexture(progressive->weights);
+    UnloadRenderTexture(progressive->resolved);
+}
+
+void ResetProgressiveRenderer(ProgressiveRenderer *progressive, float sceneTime) {
+    // Efface les deux attachements (somme et moments)
+    BeginTextureMode(progressive->accumulation);
+        ClearBackground(BLANK);
+    EndTextureMode();
+
+    progressive->frameCount = 0;
+    progressive->sampleCount = 0;
+    progressive->sceneTime = sceneTime;
+}
+
+bool IsProgressiveConverged(const ProgressiveRenderer *progressive) {
+    return progressive->sampleCount >= progressive->targetSamples;
+}
+
+// Carte de poids à partir des sommes accumulées, puis mipmaps : le dernier
+// niveau donne le poids moyen qui normalise le budget dans raytest.fs
+static void UpdateSampleWeights(ProgressiveRenderer *progressive) {
+    Texture2D accumulation = progressive->accumulation.texture;
+    RenderTexture2D target = progressive->weights;
+
+    BeginTextureMode(target);
+        BeginShaderMode(progressive->weightsShader);
+            SetShaderValueTexture(progressive->weightsShader, progressive->weightsAccumulationLoc, accumulation);
+            SetShaderValueTexture(progressive->weightsShader, progressive->weightsMomentsLoc, progressive->moments);
+            DrawTexturePro(accumulation,
+                           (Rectangle){ 0, 0, (float)accumulation.width, -(float)accumulation.height },
+                           (Rectangle){ 0, 0, (float)target.texture.width, (float)target.texture.height },
+                           (Vector2){ 0, 0 }, 0.0f, WHITE);
+        EndShaderMode();
+    EndTextureMode();
+
+    glBindTexture(GL_TEXTURE_2D, target.texture.id);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void AccumulateProgressiveFrame(ProgressiveRenderer *progressive, const SceneUniforms *raytrace, int samplesPerFrame) {
+    int width = progressive->accumulation.texture.width;
+    int height = progressive->accumulation.texture.height;
+
+    // Les premières frames sont uniformes : il faut quelques échantillons par
+    // pixel avant que la variance n'ait un sens
+    bool adaptive = progressive->adaptive && (progressive->frameCount >= PROGRESSIVE_ADAPTIVE_WARMUP);
+    if (adaptive) UpdateSampleWeights(progressive);
+
+    // Mélange additif (ONE, ONE) : rgb += somme des radiances, a += nombre
+    // d'échantillons du pixel ; moments += (somme L, somme L²)
+    BeginTextureMode(progressive->accumulation);
+        BeginBlendMode(BLEND_ADD_COLORS);
+            BeginShaderMode(raytrace->shader);
+                SetSceneAdaptiveSampling(raytrace, adaptive, progressive->weights.texture, (float)samplesPerFrame);
+                DrawRectangle(0, 0, width, height, WHITE);
+            EndShaderMode();
+        EndBlendMode();
+    EndTextureMode();
+
+    progressive->frameCount++;
+    progressive->sampleCount += samplesPerFrame;
+
+    // Résolution : moyenne, tone mapping et vignette, une fois par frame accumulée
+    float resolution[2] = { (float)width, (float)height };
+    BeginTextureMode(progressive->resolved);
+        BeginShaderMode(progressive->resolveShader);
+            SetShaderValue(progressive->resolveShader, progressive->resolutionLoc, resolution, SHADER_UNIFORM_VEC2);
+            SetShaderValueTexture(progressive->resolveShader, progressive->accumulationLoc, progressive->accumulation.texture);
+            DrawTexturePro(progressive->accumulation.texture,
+                           (Rectangle){ 0, 0, (float)width, -(float)height },
+                           (Rectangle){ 0, 0, (float)width, (float)height },
+                           (Vector2){ 0, 0 }, 0.0f, WHITE);
+        EndShaderMode();
+    EndTextureMode();
+}
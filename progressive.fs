@@ -0,0 +1,32 @@
+#version 330 core
+
+// Résolution du rendu progressif : moyenne des frames accumulées puis même
+// traitement final que raytest.fs (tone mapping ACES, gamma, vignette)
+
+in vec2 fragTexCoord;
+out vec4 fragColor;
+
+uniform sampler2D accumulation;  // somme des radiances (rgb), nombre de frames (a)
+uniform vec2 resolution;
+
+void main() {
+    vec4 sum = texture(accumulation, fragTexCoord);
+    vec3 color = sum.rgb / max(sum.a, 1.0);
+
+    // Tone mapping (ACES)
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+    color = clamp((color * (a * color + b)) / (color * (c * color + d) + e), 0.0, 1.0);
+
+    // Correction gamma
+    color = pow(color, vec3(1.0 / 2.2));
+
+    // Légère vignette
+    vec2 q = gl_FragCoord.xy / resolution.xy;
+    color *= 0.7 + 0.3 * pow(16.0 * q.x * q.y * (1.0 - q.x) * (1.0 - q.y), 0.1);
+
+    fragColor = vec4(color, 1.0);
+}
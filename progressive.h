@@ -0,0 +1,54 @@
+#ifndef PROGRESSIVE_H
+#define PROGRESSIVE_H
+
+#include "raylib.h"
+#include "scene_uniforms.h"
+
+#define PROGRESSIVE_DEFAULT_TARGET_SPP 1024   // Échantillons par pixel avant l'arrêt du tracé
+#define PROGRESSIVE_ADAPTIVE_WARMUP 2         // Frames uniformes avant l'échantillonnage adaptatif
+
+// Rendu progressif d'une image fixe : chaque frame ajoute les sommes brutes de
+// raytest.fs (linearOutput) à des buffers flottants, par mélange additif :
+// radiance et nombre d'échantillons d'un côté, moments de luminance de l'autre.
+// La résolution divise la somme par le nombre d'échantillons. Une fois
+// l'objectif atteint plus rien n'est tracé : l'image résolue est réaffichée.
+//
+// En mode adaptatif, la variance accumulée de chaque pixel donne une carte de
+// poids (progressive_weights.fs) : le budget d'échantillons de la frame est
+// réparti selon ces poids au lieu d'être uniforme.
+typedef struct {
+    RenderTexture2D accumulation;   // Attachement 0 : somme des radiances (rgb), échantillons (a), RGBA32F
+    Texture2D moments;              // Attachement 1 : somme de la luminance (r) et de son carré (g), RGBA32F
+    RenderTexture2D weights;        // Poids d'échantillonnage (r) et échantillons accumulés (g), RGBA32F avec mipmaps
+    RenderTexture2D resolved;       // Image finale (tone mapping, gamma, vignette), RGBA8
+
+    Shader resolveShader;
+    int accumulationLoc;
+    int resolutionLoc;
+
+    Shader weightsShader;
+    int weightsAccumulationLoc;
+    int weightsMomentsLoc;
+
+    bool adaptive;                  // Échantillonnage adaptatif activé
+    int frameCount;                 // Frames accumulées depuis la dernière remise à zéro
+    int sampleCount;                // Échantillons par pixel accumulés (en moyenne)
+    int targetSamples;              // Objectif d'échantillons par pixel
+    float sceneTime;                // Temps de scène figé pendant l'accumulation
+} ProgressiveRenderer;
+
+void LoadProgressiveRenderer(ProgressiveRenderer *progressive, const char *resolveFileName, const char *weightsFileName,
+                             int width, int height, int targetSamples);
+void UnloadProgressiveRenderer(ProgressiveRenderer *progressive);
+
+// Repart de zéro (changement de caméra, de scène, de niveau de qualité...)
+// en figeant le temps de scène à sceneTime
+void ResetProgressiveRenderer(ProgressiveRenderer *progressive, float sceneTime);
+
+bool IsProgressiveConverged(const ProgressiveRenderer *progressive);
+
+// Ajoute une frame de raytracing (samplesPerFrame échantillons par pixel en
+// moyenne) puis met à jour l'image résolue. linearOutput doit être activé.
+void AccumulateProgressiveFrame(ProgressiveRenderer *progressive, const SceneUniforms *raytrace, int samplesPerFrame);
+
+#endif // PROGRESSIVE_H
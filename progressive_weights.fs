@@ -0,0 +1,37 @@
+#version 330 core
+
+// Poids d'échantillonnage adaptatif du rendu progressif : erreur relative
+// estimée de la moyenne accumulée de chaque pixel. raytest.fs répartit le
+// budget d'échantillons de la frame suivante proportionnellement à ces poids.
+// Le nombre d'échantillons déjà accumulés est recopié dans g : il donne à
+// raytest.fs le début des échantillons de la frame dans la suite de Sobol.
+
+in vec2 fragTexCoord;
+out vec4 fragColor;
+
+uniform sampler2D accumulation;  // somme des radiances (rgb), nombre d'échantillons (a)
+uniform sampler2D moments;       // somme de la luminance (r) et de son carré (g)
+
+// Poids minimal : les pixels convergés (ciel) gardent une petite chance d'être
+// rééchantillonnés, sans que le budget total ne change (normalisation par la moyenne)
+#define WEIGHT_FLOOR 0.002
+// Biais sur la luminance moyenne : le bruit des zones sombres compte aussi
+#define LUMINANCE_BIAS 0.1
+// Moins de deux échantillons : variance inconnue, pixel prioritaire
+#define UNSEEN_WEIGHT 1.0
+
+void main() {
+    float n = texture(accumulation, fragTexCoord).a;
+    vec2 m = texture(moments, fragTexCoord).rg;
+
+    float weight = UNSEEN_WEIGHT;
+    if (n >= 2.0) {
+        float mean = m.r / n;
+        float variance = max(m.g / n - mean * mean, 0.0);
+
+        // Écart-type de la moyenne, relatif à la luminance
+        weight = sqrt(variance / n) / (mean + LUMINANCE_BIAS);
+    }
+
+    fragColor = vec4(weight + WEIGHT_FLOOR, n, 0.0, 1.0);
+}
@@ -1,9 +1,17 @@
 #version 330
-#define MAX_SPHERES 8
-#define MAX_BLOCKS 6
+// Niveau de qualité : normalement injecté par l'hôte à la compilation
+// (voir raytrace_variants.h), valeurs par défaut si le fichier est chargé tel quel
+#ifndef MAX_BOUNCES
 #define MAX_BOUNCES 5  // Augmenté pour plus de réalisme
+#endif
+#ifndef MAX_SAMPLES
 #define MAX_SAMPLES 8  // Anti-aliasing
+#endif
+// Profondeur maximale d'un chemin quel que soit le matériau : les matériaux
+// spéculaires peuvent dépasser MAX_BOUNCES (materialMaxDepth), dans cette limite
+#define PATH_DEPTH_LIMIT (2 * MAX_BOUNCES)
 #define PI 3.14159265
+#define BVH_STACK_SIZE 32  // >= BVH_MAX_DEPTH de bvh.h
 
 // Structures de matériaux
 #define MAT_DIFFUSE 0
@@ -15,7 +23,7 @@
 #define MAT_EAU 6
 
 
-// Structure pour les matériaux, alignée sur vec4 pour la compatibilité avec des uniformes
+// Structure pour les matériaux, alignée sur vec4 pour le layout std140 (miroir : Material2 dans scene.h)
 struct Material {
     int type;       // Type de matériau
     float roughness; // Rugosité (métal, verre)
@@ -33,38 +41,150 @@ struct Hit {
     int blockId;
 };
 
-uniform vec4 spheres[MAX_SPHERES];     // xyz = position, w = rayon
-uniform Material materials[MAX_SPHERES]; // Matériaux des sphères
-uniform int sphereCount;
+// Primitives de la scène dans des texture buffers (miroir C++ : scene_storage.h),
+// leur nombre n'est limité que par GL_MAX_TEXTURE_BUFFER_SIZE
+uniform samplerBuffer sceneSpheres; // 3 texels par sphère : position + rayon, puis Material
+uniform samplerBuffer sceneBlocks;  // 4 texels par bloc : centre, taille, puis Material
 
-uniform vec3 blocks[MAX_BLOCKS]; // Positions des blocs (pour les murs)
-uniform vec3 blockSizes[MAX_BLOCKS]; // Tailles des blocs
-uniform Material materials_block[MAX_BLOCKS]; // Matériaux des murs
-uniform int blockCount;
-//pour les lumières sur les murs
-uniform vec3 emission_block[MAX_BLOCKS]; // intensité RGB de lumière émise par le bloc
+// BVH construit sur CPU (miroir C++ : bvh.h) : 2 texels par nœud (min + leftFirst,
+// max + count) et références de primitives des feuilles
+uniform samplerBuffer bvhNodes;
+uniform isamplerBuffer bvhPrims;
+
+// Table d'alias des sources de lumière (miroir C++ : LightEntry dans light_list.h),
+// 1 texel par source : probabilité, alias, référence, probabilité de tirage
+uniform samplerBuffer lightList;
+#define LIGHT_REF_BLOCK 1       // bit 0 : 0 = sphère émissive, 1 = bloc MAT_ZONE_EMISSION
+#define LIGHT_REF_SHIFT 1
+#define BVH_PRIM_BLOCK 1        // bit 0 : 0 = sphère, 1 = bloc
+#define BVH_PRIM_NO_SHADOW 2    // bit 1 : ne projette pas d'ombre (eau)
+#define BVH_PRIM_SHIFT 2        // index de la primitive dans les bits suivants
+
+#define WAVE_SOURCE_MAX 16     // miroir de wave_sources.h
+
+// Paramètres globaux de la scène dans un bloc uniforme std140 (miroir C++ : SceneBlock dans scene.h).
+// L'ordre des champs ne doit pas être modifié sans mettre à jour scene.h.
+layout(std140) uniform SceneBlock {
+    vec3 lightPos;
+    float lightIntensity;
+    vec3 lightColor;
+    int sphereCount;
+
+    // Faisceau lumineux
+    vec3 beamDirection;
+    float beamAngle;
+    vec3 beamPosition;
+    float beamIntensity;
+    vec3 beamColor;
+    int enableBeam;
+
+    // Vagues circulaires
+    vec3 waveCenter;    // Centre du dernier impact
+    int enableWaves;    // Surface de l'eau déformée (sources vivantes ou simulation)
+    float waveDuration; // Durée des vagues (en secondes)
+    float waveAmplitude; // Amplitude des vagues
+    float waveStartTime; // Moment où les vagues ont commencé
+    float waveDecayRate; // Taux de dissipation par seconde
+    int blockCount;
+    int bvhNodeCount;   // 0 : pas de BVH, parcours linéaire des primitives
+    int lightCount;     // Entrées de lightList (0 : pas d'éclairage direct)
+    float lightTotalPower;
+
+    // Budget de rebonds par type de matériau (indice = type, 4 par ivec4) :
+    // roulette russe à partir de la profondeur minimale, arrêt à la maximale
+    // (0 = MAX_BOUNCES du niveau de qualité, -1 = PATH_DEPTH_LIMIT)
+    ivec4 materialMinDepth[2];
+    ivec4 materialMaxDepth[2];
+
+    // Sources de vagues vivantes (wave_sources.h), de la plus ancienne à la plus récente
+    int waveSourceCount;
+    vec4 waveSources[WAVE_SOURCE_MAX];  // centre (x, z), début, force (part de waveAmplitude)
+};
 
-uniform vec3 lightPos;
-uniform vec3 lightColor;
-uniform float lightIntensity;
 uniform vec2 resolution;
 uniform vec3 viewEye;
 uniform vec3 viewCenter;
-uniform float time;     // Pour le bruit
+uniform float time;     // Temps de la scène (vagues, motifs émissifs)
+uniform float frameSeed;   // Graine du bruit, différente à chaque frame
+uniform int frameIndex;    // Frame courante (position dans les séquences de Sobol)
+uniform sampler2D blueNoise;   // Bruit bleu 4 canaux, tuile BLUE_NOISE_SIZE (blue_noise.h)
+uniform sampler2D waterField;  // Hauteur + gradient des vagues de la frame (water_field.h ou water_sim.h)
+uniform vec3 waterFieldRegion; // Zone couverte par waterField : coin (x, z) et côté
+uniform sampler2D waterBounds; // Pyramide min/max de la hauteur de waterField (water_bounds.h)
+uniform int linearOutput;  // 1 : radiance HDR linéaire brute (accumulation progressive)
+
+// Échantillonnage adaptatif (rendu progressif uniquement) : le nombre
+// d'échantillons du pixel suit sampleWeights, normalisé par la moyenne de
+// l'image (dernier niveau de mipmap) pour respecter le budget total
+uniform int adaptiveSampling;
+uniform sampler2D sampleWeights;
+uniform float sampleBudget;    // Échantillons par pixel en moyenne sur l'image
+#define ADAPTIVE_MAX_SAMPLES 64
+
+// Reprojection du premier impact dans la frame précédente (TAA, débruitage) :
+// matrice vue-projection de la caméra précédente (GetSceneViewProjection),
+// G-buffer précédent et part de celui-ci qui était rendue (résolution dynamique)
+uniform mat4 previousViewProjection;
+uniform sampler2D previousNormalDepth;
+uniform vec2 previousRenderScale;
+#define REPROJECTION_DEPTH_TOLERANCE 0.05   // Écart de profondeur relatif accepté
+#define REPROJECTION_NORMAL_TOLERANCE 0.9   // cos de l'écart d'orientation accepté
 
-// Uniformes pour les vagues circulaires
-uniform vec3 waveCenter;    // Centre des ondulations
-uniform int enableWaves;    // Activer/désactiver les vagues
-uniform float waveDuration; // Durée des vagues (en secondes)
-uniform float waveAmplitude; // Amplitude des vagues
-uniform float waveStartTime; // Moment où les vagues ont commencé
-uniform float waveDecayRate; // Taux de dissipation par seconde
+// Tracé entrelacé : seul un pixel sur interleaveCount est tracé à chaque frame
+// (1 : tous, 2 : damier, 4 : un pixel par bloc 2x2), le sous-ensemble tournant
+// avec interleavePhase. Les autres ne calculent que le G-buffer du premier
+// impact et sont reconstruits ensuite (reconstruct.fs).
+uniform int interleaveCount;
+uniform int interleavePhase;
 
 uniform sampler2D previousFrame;
 uniform float frameBlend; // 0.1 to 0.2 works well
 
+// Sorties (MRT, miroir C++ : gbuffer.h) : couleur, puis G-buffer du premier impact
+layout(location = 0) out vec4 finalColor;
+layout(location = 1) out vec4 gbufferNormalDepth;  // normale + profondeur linéaire
+layout(location = 2) out float gbufferMaterial;    // type de matériau + 1 (0 = ciel)
+layout(location = 3) out vec4 gbufferReprojection; // déplacement vers la frame précédente (uv), 1 si l'historique est valide, 1 si le pixel est tracé
+layout(location = 4) out vec4 gbufferPathStats;    // longueur moyenne des chemins, part des fins par roulette, par profondeur, 1 si le pixel est tracé
+
+// Fin d'un chemin (statistiques, voir path_stats.h)
+#define PATH_END_NATURAL 0      // Ciel, source ou absorption
+#define PATH_END_ROULETTE 1
+#define PATH_END_DEPTH 2        // Profondeur maximale du matériau atteinte
+
+#define GBUFFER_SKY_DEPTH 10000.0
+
+// Lecture d'un Material stocké sur deux texels (le type est un int réinterprété en float)
+Material fetchMaterial(vec4 a, vec4 b) {
+    Material m;
+    m.type = floatBitsToInt(a.x);
+    m.roughness = a.y;
+    m.ior = a.z;
+    m.padding = a.w;
+    m.albedo = b.xyz;
+    m.padding2 = b.w;
+    return m;
+}
+
+vec4 getSphere(int i) {     // xyz = position, w = rayon
+    return texelFetch(sceneSpheres, 3*i);
+}
+
+Material getSphereMaterial(int i) {
+    return fetchMaterial(texelFetch(sceneSpheres, 3*i + 1), texelFetch(sceneSpheres, 3*i + 2));
+}
+
+vec3 getBlockCenter(int i) {
+    return texelFetch(sceneBlocks, 4*i).xyz;
+}
+
+vec3 getBlockSize(int i) {
+    return texelFetch(sceneBlocks, 4*i + 1).xyz;
+}
 
-out vec4 finalColor;
+Material getBlockMaterial(int i) {
+    return fetchMaterial(texelFetch(sceneBlocks, 4*i + 2), texelFetch(sceneBlocks, 4*i + 3));
+}
 
 // Hash function pour générer des nombres pseudo-aléatoires
 uint hash(uint x) {
@@ -80,16 +200,84 @@ float random(vec3 pos, float seed) {
     return float(h) / 4294967296.0;
 }
 
-vec2 randomVec2(vec3 pos, float seed) {
-    return vec2(
-        random(pos, seed),
-        random(pos, seed + 1.618)
-    );
+// Échantillonneur des chemins : Sobol 2D à brouillage d'Owen (Burley 2020),
+// avec un brouillage indépendant par dimension. Tous les pixels partagent la
+// même suite de points, décalée (rotation de Cranley-Patterson) par le bruit
+// bleu : l'erreur est décorrélée d'un pixel à l'autre, en hautes fréquences.
+// Les dimensions sont fixes (caméra, puis BSDF / lobe / roulette / lumières à
+// chaque rebond) pour qu'un même tirage ne serve jamais à deux décisions.
+#define BLUE_NOISE_SIZE 64
+
+#define SAMPLE_DIM_CAMERA 0u
+#define SAMPLE_DIMS_PER_BOUNCE 5u
+#define SAMPLE_DIM_BSDF(b) (1u + uint(b) * SAMPLE_DIMS_PER_BOUNCE)          // Direction du rebond (2D)
+#define SAMPLE_DIM_LOBE(b) (2u + uint(b) * SAMPLE_DIMS_PER_BOUNCE)          // Choix réflexion / réfraction
+#define SAMPLE_DIM_ROULETTE(b) (3u + uint(b) * SAMPLE_DIMS_PER_BOUNCE)      // Roulette russe
+#define ROULETTE_MIN_SURVIVAL 0.05      // Borne le poids (1/survie) des chemins qui survivent
+#define SAMPLE_DIM_LIGHT(b) (4u + uint(b) * SAMPLE_DIMS_PER_BOUNCE)         // Point sur la source tirée (2D)
+#define SAMPLE_DIM_LIGHT_SELECT(b) (5u + uint(b) * SAMPLE_DIMS_PER_BOUNCE)  // Choix de la source
+
+ivec2 samplerPixel;
+uint samplerIndex;     // Échantillon courant dans la suite de Sobol
+
+uint reverseBits32(uint x) {
+    x = ((x >> 1u) & 0x55555555u) | ((x & 0x55555555u) << 1u);
+    x = ((x >> 2u) & 0x33333333u) | ((x & 0x33333333u) << 2u);
+    x = ((x >> 4u) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4u);
+    x = ((x >> 8u) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8u);
+    return (x >> 16u) | (x << 16u);
+}
+
+// Permutation de Laine-Karras : brouillage d'Owen sur les bits inversés
+uint laineKarrasPermutation(uint x, uint seed) {
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+uint nestedUniformScramble(uint x, uint seed) {
+    return reverseBits32(laineKarrasPermutation(reverseBits32(x), seed));
+}
+
+// Deuxième dimension de Sobol (la première est l'index aux bits inversés)
+uint sobolSecondDimension(uint index) {
+    uint v = 1u << 31u;
+    uint result = 0u;
+    for (; index != 0u; index >>= 1u, v ^= v >> 1u) {
+        if ((index & 1u) != 0u) result ^= v;
+    }
+    return result;
+}
+
+void beginSample(ivec2 pixel, uint index) {
+    samplerPixel = pixel;
+    samplerIndex = index;
+}
+
+vec2 sample2D(uint dimension) {
+    uint seed = hash(dimension + 0x9e3779b9u);
+
+    // Ordre des points mélangé par dimension, puis brouillage de chaque axe
+    uint index = nestedUniformScramble(samplerIndex, seed);
+    uint x = nestedUniformScramble(reverseBits32(index), hash(seed));
+    uint y = nestedUniformScramble(sobolSecondDimension(index), hash(seed + 1u));
+    vec2 u = vec2(float(x >> 8u), float(y >> 8u)) * (1.0 / 16777216.0);
+
+    // Rotation par pixel tirée du bruit bleu, à un décalage propre à la dimension
+    ivec2 offset = ivec2(int(seed & 0xffu), int((seed >> 8u) & 0xffu));
+    vec4 noise = texelFetch(blueNoise, (samplerPixel + offset) & (BLUE_NOISE_SIZE - 1), 0);
+    return fract(u + (((seed >> 16u) & 1u) != 0u ? noise.xy : noise.zw));
+}
+
+float sample1D(uint dimension) {
+    return sample2D(dimension).x;
 }
 
 // Échantillonnage cosinus pondéré pour une meilleure distribution
-vec3 sampleHemisphere(vec3 normal, vec3 pos, float seed) {
-    vec2 rand = randomVec2(pos, seed);
+vec3 sampleHemisphere(vec3 normal, vec2 rand) {
     
     float phi = 2.0 * PI * rand.x;
     float cosTheta = sqrt(rand.y);  // Distribution en cosinus
@@ -107,11 +295,10 @@ vec3 sampleHemisphere(vec3 normal, vec3 pos, float seed) {
 }
 
 // Réflexion spéculaire avec perturbation pour rugosité
-vec3 reflect_custom(vec3 incident, vec3 normal, float roughness, vec3 pos, float seed) {
+vec3 reflect_custom(vec3 incident, vec3 normal, float roughness, vec2 rand) {
     vec3 reflected = reflect(incident, normal);
     
     if (roughness > 0.0) {
-        vec2 rand = randomVec2(pos, seed);
         float phi = 2.0 * PI * rand.x;
         float cosTheta = pow(1.0 - rand.y * roughness * roughness, 1.0 / 3.0);
         float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
@@ -130,7 +317,8 @@ vec3 reflect_custom(vec3 incident, vec3 normal, float roughness, vec3 pos, float
 }
 
 // Réfraction avec loi de Fresnel et perturbation pour rugosité
-vec3 refract(vec3 incident, vec3 normal, float ior, float roughness, vec3 pos, float seed, out float reflectionChance) {
+// (lobe : choix réflexion / réfraction, rand : perturbation du lobe choisi)
+vec3 refract_custom(vec3 incident, vec3 normal, float ior, float roughness, float lobe, vec2 rand, out float reflectionChance) {
     float eta = dot(incident, normal) < 0.0 ? 1.0 / ior : ior;
     vec3 n = dot(incident, normal) < 0.0 ? normal : -normal;
     
@@ -140,7 +328,7 @@ vec3 refract(vec3 incident, vec3 normal, float ior, float roughness, vec3 pos, f
     // Réflexion totale interne
     if (sinT2 > 1.0) {
         reflectionChance = 1.0;
-        return reflect_custom(incident, n, roughness, pos, seed);
+        return reflect_custom(incident, n, roughness, rand);
     }
     
     float cosT = sqrt(1.0 - sinT2);
@@ -151,14 +339,13 @@ vec3 refract(vec3 incident, vec3 normal, float ior, float roughness, vec3 pos, f
     
     reflectionChance = fresnel;
     
-    if (random(pos, seed + 4.269) < fresnel) {
-        return reflect_custom(incident, n, roughness, pos, seed);
+    if (lobe < fresnel) {
+        return reflect_custom(incident, n, roughness, rand);
     }
     
     vec3 refracted = normalize(eta * incident + (eta * cosI - cosT) * n);
     
     if (roughness > 0.0) {
-        vec2 rand = randomVec2(pos, seed + 2.718);
         float phi = 2.0 * PI * rand.x;
         float cosTheta = pow(1.0 - rand.y * roughness * roughness, 1.0 / 2.0);
         float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
@@ -196,92 +383,195 @@ bool intersectSphere(vec3 ro, vec3 rd, vec4 sphere, out float t, out vec3 n) {
     return true;
 }
 
-// Fonction pour calculer la hauteur des vagues circulaires
-float calculateWaveHeight(vec3 pos, vec3 waveCenter, float time) {
-    float distance = length(pos.xz - waveCenter.xz);
-    float waveSpeed = 2.0;  // Vitesse de propagation des ondes
-    float waveFreq = 3.0;   // Fréquence des ondulations
-    
-    // Calcul du temps écoulé depuis le début des vagues
-    float elapsedTime = time - waveStartTime;
-    
-    // Atténuation temporelle progressive utilisant le paramètre waveDecayRate
-    float timeAttenuation = 1.0;
-    if (elapsedTime > waveDuration) {
-        // Après la durée active, on laisse les vagues existantes se dissiper naturellement
-        // mais on n'en génère plus de nouvelles
-        
-        // Calculer à quelle distance cette onde a été générée
-        float waveAge = (distance / waveSpeed); // Temps qu'il a fallu à cette onde pour arriver ici
-        float waveGenerationTime = elapsedTime - waveAge; // Moment où cette onde a été générée
+// Champ de vagues de la frame (pré-passe water_field.fs ou simulation CPU) :
+// hauteur et gradient sur la zone waterFieldRegion, nul au-delà
+vec3 sampleWaterField(vec2 xz) {
+    vec2 uv = (xz - waterFieldRegion.xy) / waterFieldRegion.z;
+    if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) return vec3(0.0);
+    return textureLod(waterField, uv, 0.0).xyz;
+}
+
+// Normale de la surface déformée (vers le haut)
+vec3 waterFieldNormal(vec2 xz) {
+    vec3 field = sampleWaterField(xz);
+    return normalize(vec3(-field.y, 1.0, -field.z));
+}
+
+#define WATER_FIELD_SIZE 1024   // miroir de water_field.h (plus grand champ lié)
+
+// Plafond des pas du parcours de la pyramide (limite la durée d'un dessin) ;
+// chaque rayon a son propre budget, d'après les texels qu'il franchit
+#define WATER_MARCH_MAX_STEPS (4 * WATER_FIELD_SIZE)
+
+// Écart entre le rayon et la surface déformée : f(t) = y(t) - baseY - h(xz(t))
+float waterSurfaceError(vec3 ro, vec3 rd, float baseY, float t) {
+    vec3 p = ro + rd * t;
+    return p.y - baseY - sampleWaterField(p.xz).x;
+}
+
+// Racine de f encadrée par [ta, tb] (fa et fb de signes opposés ou nuls) :
+// pas de Newton-Raphson (f'(t) = rd.y - dot(grad h, rd.xz)) tant qu'ils
+// restent dans l'encadrement, fausse position (Illinois) sinon
+#define WATER_SOLVE_ITERATIONS 8
+
+float solveWaterTexel(vec3 ro, vec3 rd, float baseY, float ta, float tb, float fa, float fb) {
+    float denom = fa - fb;
+    float tm = (abs(denom) > 1e-12) ? mix(ta, tb, fa / denom) : 0.5 * (ta + tb);
+    int kept = 0;   // Borne conservée au pas précédent (méthode Illinois)
+    for (int iter = 0; iter < WATER_SOLVE_ITERATIONS; iter++) {
+        vec3 p = ro + rd * tm;
+        vec3 field = sampleWaterField(p.xz);
+        float fm = p.y - baseY - field.x;
+        if (abs(fm) < 0.0001) break;
         
-        // Si cette onde a été générée après waveDuration, elle n'existe pas
-        if (waveGenerationTime > waveDuration) {
-            return 0.0; // Pas de nouvelles vagues après le temps imparti
+        if ((fm > 0.0) == (fa > 0.0)) {
+            ta = tm; fa = fm;
+            if (kept == 1) fb *= 0.5;
+            kept = 1;
+        } else {
+            tb = tm; fb = fm;
+            if (kept == -1) fa *= 0.5;
+            kept = -1;
         }
-        
-        // Sinon, cette onde existe mais se dissipe progressivement
-        float overtimeSeconds = elapsedTime - waveDuration;
-        timeAttenuation = pow(waveDecayRate, overtimeSeconds);
-    } else if (elapsedTime < 0.0) {
-        // Si les vagues n'ont pas encore commencé
-        timeAttenuation = 0.0;
-    } else {
-        // Pendant la durée active, réduction légère pour effet naturel
-        float naturalDecay = mix(0.98, 1.0, waveDecayRate); // Plus le decay est fort, plus la réduction naturelle est faible
-        timeAttenuation = pow(naturalDecay, elapsedTime);
+        float slope = rd.y - dot(field.yz, rd.xz);
+        float tn = (abs(slope) > 1e-6) ? tm - fm / slope : ta;
+        denom = fa - fb;
+        if (!(tn > ta && tn < tb)) tn = (abs(denom) > 1e-12) ? mix(ta, tb, fa / denom) : 0.5 * (ta + tb);
+        tm = tn;
     }
-    
-    // Atténuation avec la distance (plus progressive)
-    float distanceAttenuation = exp(-distance * 0.15); // Réduit le coefficient pour une portée plus longue
-    
-    // Atténuation supplémentaire pour les vagues très éloignées (après 10 unités)
-    float farDistanceAttenuation = 1.0;
-    if (distance > 10.0) {
-        float excessDistance = distance - 10.0;
-        farDistanceAttenuation = exp(-excessDistance * 0.5); // Atténuation rapide au-delà de 10 unités
+    return tm;
+}
+
+// Premier point de [ta, tb] où le rayon traverse la surface, sur un morceau
+// où elle est bilinéaire (f quadratique en t). Sans changement de signe aux
+// bornes, l'extremum de la parabole qui passe par les bornes et le milieu dit
+// si une crête (ou un creux) coupe le rayon et retombe dans le morceau.
+bool intersectWaterPiece(vec3 ro, vec3 rd, float baseY, float ta, float tb, out float tHit) {
+    float fa = waterSurfaceError(ro, rd, baseY, ta);
+    float fb = waterSurfaceError(ro, rd, baseY, tb);
+    if (fa * fb > 0.0) {
+        // f(s) = fa + b*s + a*s², s dans [0, 1]
+        float fm = waterSurfaceError(ro, rd, baseY, 0.5 * (ta + tb));
+        float a = 2.0 * (fa + fb) - 4.0 * fm;
+        float b = 4.0 * fm - 3.0 * fa - fb;
+        if (abs(a) < 1e-12) return false;
+        float s = -b / (2.0 * a);
+        if (s <= 0.0 || s >= 1.0 || (fa + s * (b + s * a)) * fa > 0.0) return false;
+        // Encadrement vérifié sur la surface réelle (filtrage, pas une parabole exacte)
+        tb = mix(ta, tb, s);
+        fb = waterSurfaceError(ro, rd, baseY, tb);
+        if (fb * fa > 0.0) return false;
     }
-    
-    // Vérifier si l'onde a eu le temps d'atteindre cette distance
-    float timeToReachDistance = distance / waveSpeed;
-    if (elapsedTime < timeToReachDistance) {
-        return 0.0; // L'onde n'est pas encore arrivée à cette distance
+    tHit = solveWaterTexel(ro, rd, baseY, ta, tb, fa, fb);
+    return true;
+}
+
+// Texel du niveau 0, découpé aux lignes de centres de texels où changent les
+// quatre texels interpolés
+bool intersectWaterTexel(vec3 ro, vec3 rd, float baseY, ivec2 cell, float texelSize, vec2 invDir, float t0, float t1, out float tHit) {
+    vec2 centers = (waterFieldRegion.xy + (vec2(cell) + 0.5) * texelSize - ro.xz) * invDir;
+    float s0 = clamp(min(centers.x, centers.y), t0, t1);
+    float s1 = clamp(max(centers.x, centers.y), t0, t1);
+    return intersectWaterPiece(ro, rd, baseY, t0, s0, tHit)
+        || intersectWaterPiece(ro, rd, baseY, s0, s1, tHit)
+        || intersectWaterPiece(ro, rd, baseY, s1, t1, tHit);
+}
+
+// Repli si le budget de pas est épuisé : Newton-Raphson depuis t, avec le
+// gradient du champ, puis vérification de la convergence
+bool newtonWaterSurface(vec3 ro, vec3 rd, float baseY, float t, out float tHit) {
+    for (int iter = 0; iter < 4; iter++) {
+        vec3 p = ro + rd * t;
+        vec3 field = sampleWaterField(p.xz);
+        float error = p.y - (baseY + field.x);
+        if (abs(error) < 0.001) break;
+        
+        // Pente le long du rayon ; si le rayon longe la surface (pente
+        // nulle ou de signe opposé à rd.y), repli sur le pas vertical
+        float slope = rd.y - dot(field.yz, rd.xz);
+        if (slope * rd.y < 1e-6) slope = rd.y;
+        t -= error / slope;
     }
-    
-    // Atténuation temporelle des ondulations individuelles (vagues vieillissent)
-    float waveAge = elapsedTime - timeToReachDistance; // Temps depuis que l'onde est arrivée ici
-    float ageAttenuation = exp(-waveAge * 0.1); // Les vagues s'affaiblissent en vieillissant
-    
-    // Onde circulaire qui se propage avec toutes les attenuations
-    // Utiliser elapsedTime au lieu de time pour que les vagues partent du centre
-    float wave = sin(waveFreq * distance - waveSpeed * (waveStartTime + elapsedTime)) 
-                 * distanceAttenuation 
-                 * farDistanceAttenuation
-                 * timeAttenuation 
-                 * ageAttenuation;
-    
-    // Amplitude finale avec réduction progressive globale
-    float finalAmplitude = waveAmplitude * timeAttenuation;
-    
-    return wave * finalAmplitude;
+    tHit = t;
+    return abs(waterSurfaceError(ro, rd, baseY, t)) < 0.001;
 }
 
-// Fonction pour calculer la normale déformée par les vagues
-vec3 calculateWaveNormal(vec3 pos, vec3 waveCenter, float time) {
-    float eps = 0.01;
+// Premier point de [tStart, tEnd] où le rayon traverse la surface déformée
+// (hauteur baseY + champ), par parcours du quadtree min/max : une cellule dont
+// les bornes ne croisent pas la tranche de hauteurs du rayon est franchie d'un
+// coup, sinon on descend jusqu'au texel où la racine est cherchée exactement
+bool intersectWaterSurface(vec3 ro, vec3 rd, float baseY, float tStart, float tEnd, out float tHit) {
+    tHit = tEnd;
+    int size = textureSize(waterBounds, 0).x;
+    int topLevel = int(round(log2(float(size))));
+    
+    // Tranche de hauteurs de tout le champ
+    vec2 global = texelFetch(waterBounds, ivec2(0), topLevel).rg;
+    if (abs(rd.y) > 1e-6) {
+        float ta = (baseY + global.x - ro.y) / rd.y;
+        float tb = (baseY + global.y - ro.y) / rd.y;
+        tStart = max(tStart, min(ta, tb));
+        tEnd = min(tEnd, max(ta, tb));
+    } else if (ro.y < baseY + global.x || ro.y > baseY + global.y) {
+        return false;
+    }
+    
+    // Zone couverte par le champ
+    vec2 invDir = 1.0 / rd.xz;
+    vec2 r0 = (waterFieldRegion.xy - ro.xz) * invDir;
+    vec2 r1 = (waterFieldRegion.xy + waterFieldRegion.z - ro.xz) * invDir;
+    tStart = max(tStart, max(min(r0.x, r1.x), min(r0.y, r1.y)));
+    tEnd = min(tEnd, min(max(r0.x, r1.x), max(r0.y, r1.y)));
     
-    // Échantillonner la hauteur en 4 points autour de la position
-    float h0 = calculateWaveHeight(pos, waveCenter, time);
-    float hx = calculateWaveHeight(pos + vec3(eps, 0, 0), waveCenter, time);
-    float hz = calculateWaveHeight(pos + vec3(0, 0, eps), waveCenter, time);
+    if (tStart >= tEnd) return false;
     
-    // Calculer le gradient (dérivées partielles)
-    vec3 tangentX = vec3(eps, hx - h0, 0);
-    vec3 tangentZ = vec3(0, hz - h0, eps);
+    // Budget : texels du niveau 0 sous l'empreinte du rayon, chacun au prix
+    // d'une descente et d'un passage au plus (les remontées sont groupées),
+    // plus la descente initiale
+    vec2 footprint = abs(rd.xz) * (tEnd - tStart) * float(size) / waterFieldRegion.z;
+    int texels = int(ceil(footprint.x) + ceil(footprint.y)) + 1;
+    int maxSteps = min(2 * texels + topLevel, WATER_MARCH_MAX_STEPS);
     
-    // Normale = produit vectoriel des tangentes
-    vec3 normal = normalize(cross(tangentX, tangentZ));
-    return normal;
+    vec2 dirStep = step(0.0, rd.xz);
+    float t = tStart;
+    int level = topLevel;
+    for (int i = 0; i < maxSteps; i++) {
+        if (t >= tEnd) return false;
+        
+        // Cellule du niveau courant où entre le rayon en t (repérée un peu plus
+        // loin, t est souvent sur son bord), et sortie du rayon
+        int cells = size >> level;
+        float cellSize = waterFieldRegion.z / float(cells);
+        vec2 uv = (ro.xz + rd.xz * (t + 1e-4) - waterFieldRegion.xy) / cellSize;
+        ivec2 cell = clamp(ivec2(floor(uv)), ivec2(0), ivec2(cells - 1));
+        vec2 exits = (waterFieldRegion.xy + (vec2(cell) + dirStep) * cellSize - ro.xz) * invDir;
+        float tExit = min(min(exits.x, exits.y), tEnd);
+        
+        // Hauteurs du rayon dans la cellule comparées aux bornes de la surface
+        vec2 bounds = texelFetch(waterBounds, cell, level).rg + baseY;
+        float y0 = ro.y + rd.y * t;
+        float y1 = ro.y + rd.y * tExit;
+        if (min(y0, y1) <= bounds.y && max(y0, y1) >= bounds.x) {
+            if (level > 0) {
+                level--;
+                continue;
+            }
+            if (intersectWaterTexel(ro, rd, baseY, cell, cellSize, invDir, t, tExit, tHit)) return true;
+        }
+        
+        // Cellule franchie : on remonte tant que la suivante est aussi hors
+        // de la cellule parente
+        int axis = (exits.x < exits.y) ? 0 : 1;
+        bool forward = rd.xz[axis] > 0.0;
+        while (level < topLevel && (((cell[axis] & 1) == 1) == forward)) {
+            cell >>= 1;
+            level++;
+        }
+        // L'intervalle suivant commence exactement à la sortie : une racine
+        // sur le bord est vue par l'une des deux cellules
+        t = (tExit > t) ? tExit : t + 1e-4;
+    }
+    return newtonWaterSurface(ro, rd, baseY, t, tHit);
 }
 
 // Fonction d'intersection pour les boîtes alignées sur les axes (AABB) avec vagues
@@ -310,35 +600,20 @@ bool intersectBox(vec3 ro, vec3 rd, vec3 boxMin, vec3 boxMax, out float t, out v
     bool isTopSurface = (d.y > d.x && d.y > d.z && hit.y > center.y);
     
     if (isTopSurface && enableWaves == 1) {
-        // Utiliser le centre des ondulations défini par l'uniform
-        vec3 waveCenterPos = waveCenter;
-        
-        // Itération pour trouver l'intersection précise avec la surface déformée
-        float rayT = t;
-        for (int iter = 0; iter < 8; iter++) {
-            vec3 currentPos = ro + rd * rayT;
-            
-            // Hauteur de la vague à cette position
-            float waveHeight = calculateWaveHeight(currentPos, waveCenterPos, time);
-            
-            // Surface déformée
-            float surfaceY = boxMax.y + waveHeight;
-            
-            // Erreur entre la position du rayon et la surface
-            float error = currentPos.y - surfaceY;
-            
-            // Ajuster t pour converger vers la surface
-            rayT -= error / rd.y;
-            
-            // Convergence suffisante
-            if (abs(error) < 0.001) break;
+        // Parcours de la surface déformée dans l'emprise xz de la boîte. Hors de
+        // la zone du champ la surface est le plan du dessus : il reste l'impact
+        // s'il y précède celui trouvé dans la zone (ou si aucun n'est trouvé)
+        float tWater;
+        float tStart = max(max(tsmaller.x, tsmaller.z), 0.001);
+        float tEnd = min(tbigger.x, tbigger.z);
+        bool planeInField = all(greaterThanEqual(hit.xz, waterFieldRegion.xy)) && all(lessThanEqual(hit.xz, waterFieldRegion.xy + waterFieldRegion.z));
+        if (intersectWaterSurface(ro, rd, boxMax.y, tStart, tEnd, tWater) && (planeInField || tWater < t)) {
+            t = tWater;
         }
-        
-        t = rayT;
         hit = ro + rd * t;
         
-        // Calculer la normale déformée par les vagues
-        n = calculateWaveNormal(hit, waveCenterPos, time);
+        // Normale déformée par les vagues
+        n = waterFieldNormal(hit.xz);
     } else {
         // Faces normales (non déformées)
         if (d.x > d.y && d.x > d.z) {
@@ -353,70 +628,215 @@ bool intersectBox(vec3 ro, vec3 rd, vec3 boxMin, vec3 boxMax, out float t, out v
     return true;
 }
 
-Hit intersectScene(vec3 ro, vec3 rd) {
-    Hit closestHit;
-    closestHit.hit = false;
-    closestHit.t = 1e9;
+// Distance d'entrée dans une boîte englobante (1e30 si manquée ou au-delà de tMax)
+float intersectAABB(vec3 ro, vec3 invDir, vec3 bmin, vec3 bmax, float tMax) {
+    vec3 t0 = (bmin - ro) * invDir;
+    vec3 t1 = (bmax - ro) * invDir;
+    vec3 tsmaller = min(t0, t1);
+    vec3 tbigger = max(t0, t1);
+    float tEnter = max(max(tsmaller.x, tsmaller.y), tsmaller.z);
+    float tExit = min(min(tbigger.x, tbigger.y), tbigger.z);
+    if (tExit < max(tEnter, 0.0) || tEnter > tMax) return 1e30;
+    return max(tEnter, 0.0);
+}
 
-    for (int i = 0; i < blockCount; ++i) {
-        float t;
-        vec3 n;
-        vec3 boxMin = blocks[i];
-        vec3 boxMax = blocks[i] + blockSizes[i];
-
-        if (intersectBox(ro, rd, boxMin, boxMax, t, n)) {
-            if (t < closestHit.t) {
-                closestHit.hit = true;
-                closestHit.t = t;
-                closestHit.normal = n;
-                closestHit.blockId = i;
-                closestHit.matId = materials_block[i];
+float intersectNode(vec3 ro, vec3 invDir, int node, float tMax) {
+    return intersectAABB(ro, invDir, texelFetch(bvhNodes, 2*node).xyz, texelFetch(bvhNodes, 2*node + 1).xyz, tMax);
+}
+
+bool intersectBlock(vec3 ro, vec3 rd, int i, out float t, out vec3 n) {
+    vec3 halfSize = getBlockSize(i) * 0.5;
+    vec3 center = getBlockCenter(i);
+    return intersectBox(ro, rd, center - halfSize, center + halfSize, t, n);
+}
+
+// Intersection la plus proche avec toute la scène. Avec le BVH : parcours ordonné
+// (fils le plus proche d'abord) avec une petite pile, les nœuds dépilés étant
+// ignorés s'ils sont plus loin que le meilleur impact trouvé entre-temps.
+bool findClosestHit(vec3 ro, vec3 rd, out float minT, out int hitIdx, out int hitType, out vec3 n) {
+    minT = 1e9;
+    hitIdx = -1;
+    hitType = 0; // 0 = sphère, 1 = mur
+    n = vec3(0.0, 1.0, 0.0);
+
+    if (bvhNodeCount == 0) {
+        // Parcours linéaire (sans BVH)
+        for (int i = 0; i < sphereCount; ++i) {
+            float t;
+            vec3 ni;
+            if (intersectSphere(ro, rd, getSphere(i), t, ni) && t < minT) {
+                minT = t;
+                n = ni;
+                hitIdx = i;
+                hitType = 0;
+            }
+        }
+        for (int i = 0; i < blockCount; ++i) {
+            float t;
+            vec3 ni;
+            if (intersectBlock(ro, rd, i, t, ni) && t < minT) {
+                minT = t;
+                n = ni;
+                hitIdx = i;
+                hitType = 1;
             }
         }
+        return hitIdx != -1;
     }
 
-    return closestHit;
-}
+    vec3 invDir = 1.0 / rd;
+    int stack[BVH_STACK_SIZE];
+    float stackDist[BVH_STACK_SIZE];
+    int sp = 0;
+    int node = 0;
+    if (intersectNode(ro, invDir, 0, minT) >= 1e30) return false;
 
-// Fonction auxiliaire pour calculer l'éclairage direct
-vec3 directLight(vec3 p, vec3 n, vec3 viewDir, int matType, vec3 albedo, float roughness, float dist) {
-    vec3 toLight = normalize(lightPos - p);
-    float distToLight = length(lightPos - p);
-    
-    // Calculer l'intensité du faisceau pour ce point
-    //float beamIntensity = calculateBeamIntensity(p);
-    
-    // Vérifier si le point est dans l'ombre
-    bool occluded = false;
-    for (int i = 0; i < sphereCount; ++i) {
-        float t;
-        vec3 tmp;
-        if (intersectSphere(p + n * 0.001, toLight, spheres[i], t, tmp)) {
-            if (t < distToLight) {
-                occluded = true;
+    while (true) {
+        vec4 a = texelFetch(bvhNodes, 2*node);
+        vec4 b = texelFetch(bvhNodes, 2*node + 1);
+        int first = floatBitsToInt(a.w);
+        int count = floatBitsToInt(b.w);
+
+        if (count > 0) {
+            // Feuille : test de ses primitives
+            for (int k = first; k < first + count; ++k) {
+                int ref = texelFetch(bvhPrims, k).r;
+                int index = ref >> BVH_PRIM_SHIFT;
+                bool isBlock = (ref & BVH_PRIM_BLOCK) != 0;
+                float t;
+                vec3 ni;
+                bool hitPrim = isBlock ? intersectBlock(ro, rd, index, t, ni)
+                                       : intersectSphere(ro, rd, getSphere(index), t, ni);
+                if (hitPrim && t < minT) {
+                    minT = t;
+                    n = ni;
+                    hitIdx = index;
+                    hitType = isBlock ? 1 : 0;
+                }
+            }
+        } else {
+            // Nœud interne : descente dans le fils le plus proche, l'autre est empilé
+            int near = first;
+            int far = first + 1;
+            float dNear = intersectNode(ro, invDir, near, minT);
+            float dFar = intersectNode(ro, invDir, far, minT);
+            if (dFar < dNear) {
+                int tmpNode = near; near = far; far = tmpNode;
+                float tmpDist = dNear; dNear = dFar; dFar = tmpDist;
+            }
+            if (dNear < 1e30) {
+                if (dFar < 1e30 && sp < BVH_STACK_SIZE) {
+                    stack[sp] = far;
+                    stackDist[sp] = dFar;
+                    sp++;
+                }
+                node = near;
+                continue;
+            }
+        }
+
+        // Dépilement du prochain nœud encore plus proche que le meilleur impact
+        bool found = false;
+        while (sp > 0) {
+            sp--;
+            if (stackDist[sp] < minT) {
+                node = stack[sp];
+                found = true;
                 break;
             }
         }
+        if (!found) break;
     }
 
-    // Vérifier les ombres avec les murs
-    if (!occluded) {
-        for (int i = 0; i < blockCount; ++i) {
+    return hitIdx != -1;
+}
+
+// Rayon d'ombre : vrai dès qu'une primitive coupe le segment [0, tMax[.
+// La sphère skipSphere (la source elle-même) et l'eau ne projettent pas d'ombre.
+bool isOccluded(vec3 ro, vec3 rd, float tMax, int skipSphere) {
+    if (bvhNodeCount == 0) {
+        for (int j = 0; j < sphereCount; ++j) {
+            if (j == skipSphere) continue;
             float t;
             vec3 tmp;
-            vec3 halfSize = blockSizes[i] * 0.5;
-            vec3 blockMin = blocks[i] - halfSize;
-            vec3 blockMax = blocks[i] + halfSize;
-
-            if (intersectBox(p + n * 0.001, toLight, blockMin, blockMax, t, tmp)) {
-                if (t < distToLight) {
-                    occluded = true;
-                    break;
+            if (intersectSphere(ro, rd, getSphere(j), t, tmp) && t < tMax) return true;
+        }
+        for (int j = 0; j < blockCount; ++j) {
+            if (getBlockMaterial(j).type == MAT_EAU) continue;
+            float t;
+            vec3 tmp;
+            if (intersectBlock(ro, rd, j, t, tmp) && t < tMax) return true;
+        }
+        return false;
+    }
+
+    vec3 invDir = 1.0 / rd;
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0) {
+        int node = stack[--sp];
+        if (intersectNode(ro, invDir, node, tMax) >= 1e30) continue;
+
+        vec4 a = texelFetch(bvhNodes, 2*node);
+        vec4 b = texelFetch(bvhNodes, 2*node + 1);
+        int first = floatBitsToInt(a.w);
+        int count = floatBitsToInt(b.w);
+
+        if (count > 0) {
+            for (int k = first; k < first + count; ++k) {
+                int ref = texelFetch(bvhPrims, k).r;
+                if ((ref & BVH_PRIM_NO_SHADOW) != 0) continue;
+                int index = ref >> BVH_PRIM_SHIFT;
+                float t;
+                vec3 tmp;
+                if ((ref & BVH_PRIM_BLOCK) != 0) {
+                    if (intersectBlock(ro, rd, index, t, tmp) && t < tMax) return true;
+                } else if (index != skipSphere) {
+                    if (intersectSphere(ro, rd, getSphere(index), t, tmp) && t < tMax) return true;
                 }
             }
+        } else if (sp + 2 <= BVH_STACK_SIZE) {
+            stack[sp++] = first + 1;
+            stack[sp++] = first;
         }
     }
+    return false;
+}
+
+// Premier impact du rayon, retenu seulement s'il s'agit d'un mur
+Hit intersectScene(vec3 ro, vec3 rd) {
+    Hit closestHit;
+    closestHit.hit = false;
+    closestHit.t = 1e9;
+    closestHit.blockId = -1;
+
+    float t;
+    int idx;
+    int hitType;
+    vec3 n;
+    if (findClosestHit(ro, rd, t, idx, hitType, n) && hitType == 1) {
+        closestHit.hit = true;
+        closestHit.t = t;
+        closestHit.normal = n;
+        closestHit.blockId = idx;
+        closestHit.matId = getBlockMaterial(idx);
+    }
+
+    return closestHit;
+}
+
+// Fonction auxiliaire pour calculer l'éclairage direct
+vec3 directLight(vec3 p, vec3 n, vec3 viewDir, int matType, vec3 albedo, float roughness, float dist) {
+    vec3 toLight = normalize(lightPos - p);
+    float distToLight = length(lightPos - p);
     
+    // Calculer l'intensité du faisceau pour ce point
+    //float beamIntensity = calculateBeamIntensity(p);
+    
+    // Vérifier si le point est dans l'ombre (sphères et murs)
+    bool occluded = isOccluded(p + n * 0.001, toLight, distToLight, -1);
     
     if (occluded) return vec3(0.0);
     
@@ -465,121 +885,228 @@ vec3 directLight(vec3 p, vec3 n, vec3 viewDir, int matType, vec3 albedo, float r
     return lightContrib;
 }
 
+// Puissance émise des sources, au facteur pi près (même formule que light_list.cpp)
+#define LIGHT_ZONE_EMISSION_COVERAGE 0.2   // Part allumée d'un bloc MAT_ZONE_EMISSION
+
+float sphereLightPower(vec4 sphere, vec3 albedo) {
+    return dot(albedo, vec3(0.2126, 0.7152, 0.0722)) * 4.0 * PI * sphere.w * sphere.w;
+}
+
+// Motif animé des blocs MAT_ZONE_EMISSION (défini plus bas)
+float emissionPattern(vec3 hitPos, vec3 blockMin, vec3 blockMax, float time);
+
+float blockLightPower(vec3 size) {
+    return LIGHT_ZONE_EMISSION_COVERAGE * 2.0 * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+// Tirage d'une source proportionnellement à sa puissance (table d'alias, coût
+// constant quel que soit le nombre de sources). Retourne sa référence (LIGHT_REF_*).
+int selectLight(float u, out float selectPdf) {
+    float scaled = u * float(lightCount);
+    int slot = min(int(scaled), lightCount - 1);
+    vec4 entry = texelFetch(lightList, slot);
+    int chosen = (fract(scaled) < entry.x) ? slot : floatBitsToInt(entry.y);
+    vec4 light = (chosen == slot) ? entry : texelFetch(lightList, chosen);
+    selectPdf = light.w;
+    return floatBitsToInt(light.z);
+}
+
+// Densité (angle solide) de l'échantillonnage du cône sous-tendu par une sphère
+// lumineuse vue depuis p, 0 si p est à l'intérieur
+float sphereLightPdf(vec3 p, vec4 sphere) {
+    vec3 toCenter = sphere.xyz - p;
+    float dist2 = dot(toCenter, toCenter);
+    float radius2 = sphere.w * sphere.w;
+    if (dist2 <= radius2) return 0.0;
+    float cosThetaMax = sqrt(1.0 - radius2 / dist2);
+    return 1.0 / (2.0 * PI * (1.0 - cosThetaMax));
+}
+
+// Direction uniforme dans le cône qui sous-tend la sphère (la calotte visible
+// depuis p), distance jusqu'à la calotte
+vec3 sampleSphereLight(vec3 p, vec4 sphere, vec2 rand, out float distToLight) {
+    vec3 toCenter = sphere.xyz - p;
+    float distToCenter = length(toCenter);
+    vec3 w = toCenter / distToCenter;
+    float sinThetaMax2 = (sphere.w * sphere.w) / (distToCenter * distToCenter);
+    float cosThetaMax = sqrt(1.0 - sinThetaMax2);
+
+    float phi = 2.0 * PI * rand.x;
+    float cosTheta = 1.0 - rand.y * (1.0 - cosThetaMax);
+    float sinTheta = sqrt(max(0.0, 1.0 - cosTheta * cosTheta));
+
+    vec3 up = abs(w.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+    vec3 tangent = normalize(cross(up, w));
+    vec3 bitangent = cross(w, tangent);
+    vec3 dir = normalize(tangent * (cos(phi) * sinTheta) + bitangent * (sin(phi) * sinTheta) + w * cosTheta);
+
+    float b = dot(toCenter, dir);
+    distToLight = b - sqrt(max(0.0, sphere.w * sphere.w - (distToCenter * distToCenter - b * b)));
+    return dir;
+}
+
+// Faces d'un bloc tournées vers p (au plus une par axe) : côté de chacune (-1, 0, 1)
+vec3 blockVisibleSides(vec3 p, vec3 center, vec3 halfSize) {
+    return vec3(greaterThan(p, center + halfSize)) - vec3(lessThan(p, center - halfSize));
+}
+
+// Aire des faces d'un bloc visibles depuis p (0 si p est à l'intérieur)
+float blockVisibleArea(vec3 p, int i) {
+    vec3 halfSize = getBlockSize(i) * 0.5;
+    vec3 faceAreas = 4.0 * halfSize.yxx * halfSize.zzy;
+    return dot(faceAreas, abs(blockVisibleSides(p, getBlockCenter(i), halfSize)));
+}
+
+// Densité (angle solide) de l'échantillonnage d'un bloc en un point de sa surface
+float blockLightPdf(vec3 p, int i, vec3 point, vec3 normal) {
+    float area = blockVisibleArea(p, i);
+    vec3 toPoint = point - p;
+    float dist2 = dot(toPoint, toPoint);
+    float cosLight = abs(dot(normal, toPoint)) / sqrt(dist2);
+    return (area > 0.0 && cosLight > 0.0) ? dist2 / (cosLight * area) : 0.0;
+}
+
+// Point uniforme sur les faces d'un bloc visibles depuis p (face choisie selon son aire)
+bool sampleBlockLight(vec3 p, int i, vec2 rand, out vec3 point, out vec3 normal) {
+    vec3 center = getBlockCenter(i);
+    vec3 halfSize = getBlockSize(i) * 0.5;
+    vec3 sides = blockVisibleSides(p, center, halfSize);
+    vec3 visible = 4.0 * halfSize.yxx * halfSize.zzy * abs(sides);
+    float total = visible.x + visible.y + visible.z;
+    if (total <= 0.0) return false;
+
+    float u = rand.x * total;
+    int axis = (u < visible.x) ? 0 : (u < visible.x + visible.y) ? 1 : 2;
+    float before = (axis == 0) ? 0.0 : (axis == 1) ? visible.x : visible.x + visible.y;
+    float v = clamp((u - before) / visible[axis], 0.0, 1.0);
+    int a1 = (axis + 1) % 3;
+    int a2 = (axis + 2) % 3;
+
+    point = center;
+    point[axis] += sides[axis] * halfSize[axis];
+    point[a1] += (2.0 * v - 1.0) * halfSize[a1];
+    point[a2] += (2.0 * rand.y - 1.0) * halfSize[a2];
+    normal = vec3(0.0);
+    normal[axis] = sides[axis];
+    return true;
+}
+
+// Heuristique de puissance (beta = 2) pour le MIS entre deux stratégies
+float powerHeuristic(float pdfA, float pdfB) {
+    float a = pdfA * pdfA;
+    float b = pdfB * pdfB;
+    return (a + b > 0.0) ? a / (a + b) : 0.0;
+}
+
+// BRDF utilisée par l'éclairage direct pour une direction vers la lumière
+vec3 evalLightBrdf(Material mat, vec3 n, vec3 viewDir, vec3 toLight, float cosLight) {
+    vec3 brdf = vec3(0.0);
+    if (mat.type == MAT_DIFFUSE) {
+        brdf = mat.albedo / PI; // Lambert
+    }
+    else if (mat.type == MAT_METALLIC) {
+        vec3 halfwayDir = normalize(toLight + viewDir);
+        float spec = pow(max(dot(n, halfwayDir), 0.0), (1.0 - mat.roughness) * 128.0 + 1.0);
+        brdf = (mat.albedo + spec * (1.0 - mat.roughness)) / PI;
+    }
+    else if (mat.type == MAT_GLASS) {
+        // Approximation simple pour le verre
+        vec3 reflectDir = reflect(-toLight, n);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), (1.0 - mat.roughness) * 128.0 + 1.0);
+        brdf = vec3(spec * (1.0 - mat.roughness)) / PI;
+    }
+    else if (mat.type == MAT_MIRROR) {
+        // Pour un miroir parfait, on vérifie si la direction réfléchie pointe vers la source
+        vec3 reflectDir = reflect(-viewDir, n);
+        
+        // Vérifier si la direction réfléchie est alignée avec la direction vers la lumière
+        float alignment = dot(normalize(reflectDir), toLight);
+        
+        // Seuil pour considérer l'alignement (plus strict pour un miroir parfait)
+        float threshold = 0.999; // Très strict pour un miroir parfait
+        
+        if (alignment > threshold) {
+            // Réflexion parfaite : la BRDF est 1/cos(theta) pour compenser la géométrie
+            brdf = mat.albedo / max(cosLight, 0.001); // Éviter division par 0
+        }
+    }
+    else if (mat.type == MAT_EAU) {
+        // Pour l'eau calme, comportement similaire au miroir avec teinte d'eau
+        vec3 reflectDir = reflect(-viewDir, n);
+        
+        float alignment = dot(normalize(reflectDir), toLight);
+        float threshold = 0.995; // Légèrement moins strict que le miroir
+        
+        if (alignment > threshold) {
+            // Teinte bleu-vert de l'eau sur la réflexion
+            brdf = vec3(0.8, 0.9, 1.0) / max(cosLight, 0.001);
+        }
+    }
+    return brdf;
+}
+
 //fonction d'échantillonnage direct de la lumière
-vec3 sampleDirectLight(vec3 p, vec3 n, vec3 viewDir, Material mat, float seed) {
+// Une seule source par point, tirée selon sa puissance (selectLight) : direction
+// dans le cône d'une sphère émissive ou point sur les faces visibles d'un bloc
+// MAT_ZONE_EMISSION. Sur les surfaces diffuses, pondération MIS avec
+// l'échantillonnage cosinus du rebond suivant (voir trace), sauf au dernier
+// sommet du chemin (lastVertex) dont le rebond n'est pas tracé.
+vec3 sampleDirectLight(vec3 p, vec3 n, vec3 viewDir, Material mat, int bounce, bool lastVertex) {
+    if (lightCount == 0) return vec3(0.0);
+
     // Éviter l'auto-intersection avec un petit décalage
     vec3 origin = p + n * 0.001;
-    vec3 contrib = vec3(0.0);
-    
-    // Trouver les sources de lumière émissives (sphères)
-    for (int i = 0; i < sphereCount; ++i) {
-        if (materials[i].type == MAT_EMISSIVE) {
-            // Échantillonnage de la sphère lumineuse
-            vec3 lightCenter = spheres[i].xyz;
-            float lightRadius = spheres[i].w;
-            float distToLight = length(lightCenter - p);
-            
-            // Génération d'un point aléatoire sur la sphère lumineuse
-            vec2 rand = randomVec2(p, seed + float(i) * 0.773);
-            float phi = 2.0 * PI * rand.x;
-            float cosTheta = 2.0 * rand.y - 1.0;
-            float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
-            
-            vec3 sampleOffset = lightRadius * vec3(
-                cos(phi) * sinTheta,
-                sin(phi) * sinTheta,
-                cosTheta
-            );
-            
-            vec3 lightPos = lightCenter + sampleOffset;
-            vec3 toLight = normalize(lightPos - p);
-            
-            // Vérifier la visibilité (ombres)
-            bool occluded = false;
-            for (int j = 0; j < sphereCount; ++j) {
-                if (j == i) continue; // Ignorer la source
-                float t;
-                vec3 tmp;
-                if (intersectSphere(origin, toLight, spheres[j], t, tmp)) {
-                    if (t < distToLight) {
-                        occluded = true;
-                        break;
-                    }
-                }
-            }
-            
-            if (!occluded) {
-                // Calculer la contribution de cette lumière
-                float solidAngle = 2.0 * PI * (1.0 - sqrt(1.0 - (lightRadius*lightRadius)/(distToLight*distToLight)));
-                float cosLight = max(0.0, dot(n, toLight));
-                
-                // BRDF selon le matériau
-                vec3 brdf = vec3(0.0);
-                if (mat.type == MAT_DIFFUSE) {
-                    brdf = mat.albedo / PI; // Lambert
-                }
-                else if (mat.type == MAT_METALLIC) {
-                    vec3 halfwayDir = normalize(toLight + viewDir);
-                    float spec = pow(max(dot(n, halfwayDir), 0.0), (1.0 - mat.roughness) * 128.0 + 1.0);
-                    brdf = (mat.albedo + spec * (1.0 - mat.roughness)) / PI;
-                }
-                else if (mat.type == MAT_GLASS) {
-                    // Approximation simple pour le verre
-                    vec3 reflectDir = reflect(-toLight, n);
-                    float spec = pow(max(dot(viewDir, reflectDir), 0.0), (1.0 - mat.roughness) * 128.0 + 1.0);
-                    brdf = vec3(spec * (1.0 - mat.roughness)) / PI;
-                }
-                else if (mat.type == MAT_MIRROR) {
-                    // Pour un miroir parfait, on vérifie si la direction réfléchie pointe vers la source
-                    vec3 reflectDir = reflect(-viewDir, n);
-                    vec3 toReflectedLight = normalize(lightPos - p);
-                    
-                    // Vérifier si la direction réfléchie est alignée avec la direction vers la lumière
-                    float alignment = dot(normalize(reflectDir), toReflectedLight);
-                    
-                    // Seuil pour considérer l'alignement (plus strict pour un miroir parfait)
-                    float threshold = 0.999; // Très strict pour un miroir parfait
-                    
-                    if (alignment > threshold) {
-                        // Réflexion parfaite : la BRDF est 1/cos(theta) pour compenser la géométrie
-                        float cosTheta = max(0.0, dot(n, toReflectedLight));
-                        brdf = mat.albedo / max(cosTheta, 0.001); // Éviter division par 0
-                    } else {
-                        brdf = vec3(0.0); // Pas de contribution si pas d'alignement parfait
-                    }
-                }
-                else if (mat.type == MAT_EAU) {
-                    // Pour l'eau calme, comportement similaire au miroir avec teinte d'eau
-                    vec3 reflectDir = reflect(-viewDir, n);
-                    vec3 toReflectedLight = normalize(lightPos - p);
-                    
-                    float alignment = dot(normalize(reflectDir), toReflectedLight);
-                    float threshold = 0.995; // Légèrement moins strict que le miroir
-                    
-                    if (alignment > threshold) {
-                        float cosTheta = max(0.0, dot(n, toReflectedLight));
-                        // Teinte bleu-vert de l'eau sur la réflexion
-                        brdf = vec3(0.8, 0.9, 1.0) / max(cosTheta, 0.001);
-                    } else {
-                        brdf = vec3(0.0);
-                    }
-                }
-                // Calcul du PDF
-                float distance2 = dot(lightPos - p, lightPos - p);
-                float cosTheta = max(dot(toLight, -normalize(sampleOffset)), 0.0);
-                float pdf = distance2 / (cosTheta * 4.0 * PI * lightRadius * lightRadius + 0.001); // éviter /0
-
-                // Contribution lumineuse si pdf valide
-                if (pdf > 0.0) {
-                    vec3 Li = materials[i].albedo * lightIntensity;
-                    float cosLight = max(0.0, dot(n, toLight));
-                    contrib += brdf * Li * cosLight / pdf;
-                }
-            }
-        }
+
+    float selectPdf;
+    int ref = selectLight(sample1D(SAMPLE_DIM_LIGHT_SELECT(bounce)), selectPdf);
+    int index = ref >> LIGHT_REF_SHIFT;
+    vec2 rand = sample2D(SAMPLE_DIM_LIGHT(bounce));
+
+    vec3 toLight;
+    float distToLight;
+    float lightPdf;
+    int skipSphere = -1;
+    vec3 Li = vec3(lightIntensity);
+
+    if ((ref & LIGHT_REF_BLOCK) == 0) {
+        vec4 sphere = getSphere(index);
+        lightPdf = sphereLightPdf(p, sphere);
+        if (lightPdf == 0.0) return vec3(0.0);  // Point à l'intérieur de la source
+        toLight = sampleSphereLight(p, sphere, rand, distToLight);
+        skipSphere = index;
+        Li *= getSphereMaterial(index).albedo;
+    } else {
+        vec3 point;
+        vec3 normal;
+        if (!sampleBlockLight(p, index, rand, point, normal)) return vec3(0.0);
+        lightPdf = blockLightPdf(p, index, point, normal);
+        if (lightPdf == 0.0) return vec3(0.0);
+
+        // Seules les zones allumées du motif émettent à cet instant
+        vec3 halfSize = getBlockSize(index) * 0.5;
+        vec3 blockCenter = getBlockCenter(index);
+        if (emissionPattern(point, blockCenter - halfSize, blockCenter + halfSize, time) <= 0.0) return vec3(0.0);
+
+        toLight = normalize(point - p);
+        distToLight = length(point - p) - 0.001;   // Sans compter le bloc lui-même
     }
-    
-    return contrib;
+
+    float cosLight = max(0.0, dot(n, toLight));
+    if (cosLight == 0.0 && mat.type == MAT_DIFFUSE) return vec3(0.0);   // Sous l'horizon
+
+    // Vérifier la visibilité (ombres), en ignorant la source
+    if (isOccluded(origin, toLight, distToLight, skipSphere)) return vec3(0.0);
+
+    vec3 brdf = evalLightBrdf(mat, n, viewDir, toLight, cosLight);
+
+    // Surfaces diffuses : la même lumière peut aussi être atteinte par le
+    // rebond suivant (échantillonnage cosinus), les deux sont pondérées. Au
+    // dernier sommet ce rebond n'existe pas, l'échantillon de la lumière compte
+    // seul.
+    float pdf = selectPdf * lightPdf;
+    float misWeight = (mat.type == MAT_DIFFUSE && !lastVertex) ? powerHeuristic(pdf, cosLight / PI) : 1.0;
+
+    return brdf * Li * cosLight * misWeight / pdf;
 }
 
 // Fonction hash 2D rapide pour du bruit pseudo-aléatoire
@@ -620,49 +1147,75 @@ float emissionPattern(vec3 hitPos, vec3 blockMin, vec3 blockMax, float time) {
 
 
 
-vec3 trace(vec3 ro, vec3 rd, float seed) {
-    vec3 col = vec3(0.0);
-    vec3 throughput = vec3(1.0);
+// Matériau au point d'impact (les zones d'émission dépendent de la position et du temps)
+Material getHitMaterial(int hitIdx, int hitType, vec3 hit) {
+    if (hitType == 0) return getSphereMaterial(hitIdx);
 
-    for (int bounce = 0; bounce < MAX_BOUNCES; ++bounce) {
-        float minT = 1e9;
-        int hitIdx = -1;
-        int hitType = 0; // 0 = sphère, 1 = mur
-        vec3 n, hit;
-        
-        // Trouver l'intersection la plus proche
-        for (int i = 0; i < sphereCount; ++i) {
-            float t;
-            vec3 ni;
-            if (intersectSphere(ro, rd, spheres[i], t, ni)) {
-                if (t < minT) {
-                    minT = t;
-                    hit = ro + rd * t;
-                    n = ni;
-                    hitIdx = i;
-                    hitType = 0;
-                }
-            }
+    vec3 halfSize = getBlockSize(hitIdx) * 0.5;
+    vec3 blockMin = getBlockCenter(hitIdx) - halfSize;
+    vec3 blockMax = getBlockCenter(hitIdx) + halfSize;
+
+    Material matBase = getBlockMaterial(hitIdx);
+    //verif que le mur est de type 5 MAT_ZONE_EMISSION
+    if (matBase.type == MAT_ZONE_EMISSION) {
+        float emissionFactor = emissionPattern(hit, blockMin, blockMax, time);
+        if (emissionFactor > 0.0) {
+            matBase.type = MAT_EMISSIVE;
+            matBase.albedo = vec3(1.0);  // ou couleur désirée
         }
+        // Sinon garder le matériau de base (MAT_ZONE_EMISSION se comporte comme le matériau sous-jacent)
+    }
+    return matBase;
+}
 
-        // Trouver l'intersection la plus proche avec les murs
-        for (int i = 0; i < blockCount; ++i) {
-            float t;
-            vec3 ni;
-            vec3 halfSize = blockSizes[i] * 0.5;
-            vec3 blockMin = blocks[i] - halfSize;
-            vec3 blockMax = blocks[i] + halfSize;
+// G-buffer seul (premier impact, sans ombrage) : pixels non tracés du mode entrelacé
+void traceFirstHit(vec3 ro, vec3 rd, out vec4 normalDepth, out float material) {
+    float minT;
+    int hitIdx;
+    int hitType;
+    vec3 n;
+    normalDepth = vec4(0.0, 0.0, 0.0, GBUFFER_SKY_DEPTH);
+    material = 0.0;
+    if (!findClosestHit(ro, rd, minT, hitIdx, hitType, n)) return;
 
-            if (intersectBox(ro, rd, blockMin, blockMax, t, ni)) {
-                if (t < minT) {
-                    minT = t;
-                    hit = ro + rd * t;
-                    n = ni;
-                    hitIdx = i;
-                    hitType = 1;
-                }
-            }
-        }
+    normalDepth = vec4(n, minT * dot(rd, normalize(viewCenter - viewEye)));
+    material = float(getHitMaterial(hitIdx, hitType, ro + rd * minT).type + 1);
+}
+
+// Profondeurs minimale (début de la roulette) et maximale d'un chemin qui
+// repart d'une surface de ce type (maximale 0 : MAX_BOUNCES, -1 : PATH_DEPTH_LIMIT)
+ivec2 materialDepthRange(int type) {
+    int minDepth = materialMinDepth[type >> 2][type & 3];
+    int maxDepth = materialMaxDepth[type >> 2][type & 3];
+    if (maxDepth == 0) maxDepth = MAX_BOUNCES;
+    if (maxDepth < 0) maxDepth = PATH_DEPTH_LIMIT;
+    return ivec2(minDepth, maxDepth);
+}
+
+// firstNormalDepth / firstMaterial : informations du premier impact (G-buffer)
+// pathLength : nombre de segments tracés, pathEnd : cause de l'arrêt (PATH_END_*)
+vec3 trace(vec3 ro, vec3 rd, out vec4 firstNormalDepth, out float firstMaterial, out int pathLength, out int pathEnd) {
+    vec3 col = vec3(0.0);
+    vec3 throughput = vec3(1.0);
+    firstNormalDepth = vec4(0.0, 0.0, 0.0, GBUFFER_SKY_DEPTH);
+    firstMaterial = 0.0;
+    vec3 camForward = normalize(viewCenter - viewEye);
+    // Densité (angle solide) du rebond précédent, pour le MIS avec sampleDirectLight ;
+    // 0 quand la lumière n'y a pas été échantillonnée (caméra, lobes spéculaires)
+    float bsdfPdf = 0.0;
+    pathLength = 0;
+    pathEnd = PATH_END_DEPTH;
+
+    for (int bounce = 0; bounce < PATH_DEPTH_LIMIT; ++bounce) {
+        pathLength = bounce + 1;
+        float minT;
+        int hitIdx;
+        int hitType; // 0 = sphère, 1 = mur
+        vec3 n;
+        
+        // Trouver l'intersection la plus proche (sphères et murs)
+        findClosestHit(ro, rd, minT, hitIdx, hitType, n);
+        vec3 hit = ro + rd * minT;
 
         // Si pas d'intersection, ajouter un fond dégradé et sortir
         if (hitIdx == -1) {
@@ -693,38 +1246,38 @@ vec3 trace(vec3 ro, vec3 rd, float seed) {
             vec3 skyHorizon = vec3(1, 0.788, 0.592);  // Beige clair
             vec3 skyColor = mix(skyHorizon, skyTop, t);
             col += throughput * skyColor * 0.35;
+            pathEnd = PATH_END_NATURAL;
             break;
         }
 
         // Après avoir trouvé l'intersection:
-        Material mat;
-        if (hitType == 1) {
-            vec3 halfSize = blockSizes[hitIdx] * 0.5;
-            vec3 blockMin = blocks[hitIdx] - halfSize;
-            vec3 blockMax = blocks[hitIdx] + halfSize;
-
-            Material matBase = materials_block[hitIdx];
-            //verif que le mur est de type 5 MAT_ZONE_EMISSION
-            if (matBase.type == MAT_ZONE_EMISSION) {
-                float emissionFactor = emissionPattern(hit, blockMin, blockMax, time);
-                if (emissionFactor > 0.0) {
-                    matBase.type = MAT_EMISSIVE;
-                    matBase.albedo = vec3(1.0);  // ou couleur désirée
-                }
-                // Sinon garder le matériau de base (MAT_ZONE_EMISSION se comporte comme le matériau sous-jacent)
-            }
-            mat = matBase;
-        } else {
-            mat = materials[hitIdx];
-        }        
+        Material mat = getHitMaterial(hitIdx, hitType, hit);
+        if (bounce == 0) {
+            firstNormalDepth = vec4(n, minT * dot(rd, camForward));
+            firstMaterial = float(mat.type + 1);
+        }
         // Si on touche une source émissive, ajouter sa contribution et terminer
+        // (part de l'échantillonnage BSDF si la sphère l'a aussi été par sampleDirectLight)
         if (mat.type == MAT_EMISSIVE) {
-            col += throughput * mat.albedo * lightIntensity;
+            float misWeight = 1.0;
+            if (bsdfPdf > 0.0 && lightTotalPower > 0.0) {
+                float lightPdf = (hitType == 0) ?
+                    sphereLightPower(getSphere(hitIdx), mat.albedo) / lightTotalPower * sphereLightPdf(ro, getSphere(hitIdx)) :
+                    blockLightPower(getBlockSize(hitIdx)) / lightTotalPower * blockLightPdf(ro, hitIdx, hit, n);
+                misWeight = powerHeuristic(bsdfPdf, lightPdf);
+            }
+            col += throughput * mat.albedo * lightIntensity * misWeight;
+            pathEnd = PATH_END_NATURAL;
             break;
         }
         
+        // Budget du matériau (voir la fin de la boucle) : au dernier sommet, le
+        // rebond suivant ne sera pas tracé
+        ivec2 depthRange = materialDepthRange(mat.type);
+        bool lastVertex = (bounce + 1 >= min(depthRange.y, PATH_DEPTH_LIMIT));
+
         // Ajout de l'échantillonnage direct de la lumière (NEE)
-        vec3 directLight = sampleDirectLight(hit, n, -rd, mat, seed + float(bounce) * 1.618);
+        vec3 directLight = sampleDirectLight(hit, n, -rd, mat, bounce, lastVertex);
         col += throughput * directLight;
         
         //// Récupérer les propriétés du matériau
@@ -735,15 +1288,17 @@ vec3 trace(vec3 ro, vec3 rd, float seed) {
         //col += throughput * direct;
         
         // Calculer le prochain rayon en fonction du matériau
+        bsdfPdf = 0.0;
         if (mat.type == MAT_DIFFUSE) {
             // Surface diffuse: échantillonnage de l'hémisphère
-            rd = sampleHemisphere(n, hit, seed + float(bounce) * 3.14159);
+            rd = sampleHemisphere(n, sample2D(SAMPLE_DIM_BSDF(bounce)));
             ro = hit + n * 0.001;
             throughput *= mat.albedo;
+            bsdfPdf = max(dot(n, rd), 0.0) / PI;
         }
         else if (mat.type == MAT_METALLIC) {
             // Surface métallique: réflexion
-            rd = reflect_custom(rd, n, mat.roughness, hit, seed + float(bounce) * 2.71828);
+            rd = reflect_custom(rd, n, mat.roughness, sample2D(SAMPLE_DIM_BSDF(bounce)));
             ro = hit + n * 0.001;
             throughput *= mat.albedo;
         }
@@ -752,21 +1307,22 @@ vec3 trace(vec3 ro, vec3 rd, float seed) {
             vec3 emitCol = mat.albedo;
 
             if (hitType == 1) { // mur
-                vec3 blockMin = blocks[hitIdx] - 0.5 * blockSizes[hitIdx];
-                vec3 blockMax = blocks[hitIdx] + 0.5 * blockSizes[hitIdx];
+                vec3 blockMin = getBlockCenter(hitIdx) - 0.5 * getBlockSize(hitIdx);
+                vec3 blockMax = getBlockCenter(hitIdx) + 0.5 * getBlockSize(hitIdx);
                 float strength = emissionPattern(hit, blockMin, blockMax, time);
                 emitCol *= strength;
             }
 
             col += throughput * emitCol * lightIntensity;
             //col += vec3(1.0, 0.0, 0.0); // lumière rouge vive fixe
+            pathEnd = PATH_END_NATURAL;
             break;
         }
 
         else if (mat.type == MAT_GLASS) {
             // Verre: réfraction ou réflexion
             float reflChance;
-            rd = refract(rd, n, mat.ior, mat.roughness, hit, seed + float(bounce) * 1.41421, reflChance);
+            rd = refract_custom(rd, n, mat.ior, mat.roughness, sample1D(SAMPLE_DIM_LOBE(bounce)), sample2D(SAMPLE_DIM_BSDF(bounce)), reflChance);
             ro = hit + normalize(rd) * 0.001;
             
             // Le verre absorbe un peu de lumière, principalement sur les longues distances
@@ -783,7 +1339,7 @@ vec3 trace(vec3 ro, vec3 rd, float seed) {
                 rd = reflect(rd, n);
             } else {
                 // Réflexion avec rugosité
-                rd = reflect_custom(rd, n, mat.roughness, hit, seed + float(bounce) * 1.73205);
+                rd = reflect_custom(rd, n, mat.roughness, sample2D(SAMPLE_DIM_BSDF(bounce)));
             }
             ro = hit + n * 0.001;
             throughput *= mat.albedo;
@@ -797,7 +1353,7 @@ vec3 trace(vec3 ro, vec3 rd, float seed) {
             float fresnel = r0 + (1.0 - r0) * pow(1.0 - cosI, 5.0);
             
             // Pour eau calme, on privilégie la réflexion (90% du temps)
-            if (random(hit, seed + float(bounce) * 1.41421) < 0.9) {
+            if (sample1D(SAMPLE_DIM_LOBE(bounce)) < 0.9) {
                 // Réflexion parfaite (eau calme = miroir parfait)
                 rd = reflect(rd, n);
                 ro = hit + n * 0.001;
@@ -822,12 +1378,18 @@ vec3 trace(vec3 ro, vec3 rd, float seed) {
         
 
         
-        // Roulette russe pour terminer prématurément les chemins à faible contribution
-        if (bounce > 2) {
-            float p = max(throughput.r, max(throughput.g, throughput.b));
-            p = clamp(p, 0.0, 1.0);  // Ensure p stays in valid probability range
-            if (random(hit, seed + bounce * 0.77) > p) break;
-            throughput /= p;
+        // Budget du matériau : arrêt à sa profondeur maximale, sinon roulette
+        // russe dès sa profondeur minimale. La survie suit le throughput (déjà
+        // divisé par les survies précédentes) : les chemins sombres s'arrêtent
+        // tôt, les chemins clairs (verre, eau) continuent, sans biais.
+        if (lastVertex) break;
+        if (bounce + 1 >= depthRange.x) {
+            float survival = clamp(max(throughput.r, max(throughput.g, throughput.b)), ROULETTE_MIN_SURVIVAL, 1.0);
+            if (sample1D(SAMPLE_DIM_ROULETTE(bounce)) >= survival) {
+                pathEnd = PATH_END_ROULETTE;
+                break;
+            }
+            throughput /= survival;
         }
     }
     
@@ -842,39 +1404,140 @@ mat3 setCamera(vec3 ro, vec3 ta) {
     return mat3(cu, cv, cw);
 }
 
+// Position du pixel dans la frame précédente, d'après la profondeur du premier
+// impact le long du rayon central (sans jitter). xy : déplacement en uv de la
+// sortie, z : 1 si le même point était visible (0 = désocclusion ou hors champ).
+vec4 reprojectPixel(mat3 cam, vec4 normalDepth) {
+    vec2 uv = (gl_FragCoord.xy * 2.0 - resolution.xy) / resolution.y;
+    vec3 rd = cam * normalize(vec3(uv, 1.5));
+
+    // Ciel : seule la direction compte (point à l'infini)
+    bool sky = normalDepth.a >= GBUFFER_SKY_DEPTH;
+    vec4 world = sky ? vec4(rd, 0.0) : vec4(viewEye + rd * (normalDepth.a / dot(rd, cam[2])), 1.0);
+    vec4 clip = previousViewProjection * world;
+
+    vec2 currUv = gl_FragCoord.xy / resolution.xy;
+    if (clip.w <= 0.0) return vec4(0.0);   // Derrière la caméra précédente
+    vec2 prevUv = clip.xy / clip.w * 0.5 + 0.5;
+    if (any(lessThan(prevUv, vec2(0.0))) || any(greaterThan(prevUv, vec2(1.0)))) return vec4(prevUv - currUv, 0.0, 0.0);
+
+    // Rejet des désocclusions : le G-buffer précédent doit montrer la même surface
+    ivec2 prevSize = textureSize(previousNormalDepth, 0);
+    ivec2 prevPixel = min(ivec2(prevUv * previousRenderScale * vec2(prevSize)), prevSize - 1);
+    vec4 prev = texelFetch(previousNormalDepth, prevPixel, 0);
+    bool valid = sky ? (prev.a >= GBUFFER_SKY_DEPTH) :
+                 (abs(prev.a - clip.w) < REPROJECTION_DEPTH_TOLERANCE * clip.w &&
+                  dot(prev.rgb, normalDepth.rgb) > REPROJECTION_NORMAL_TOLERANCE);
+    return vec4(prevUv - currUv, valid ? 1.0 : 0.0, 0.0);
+}
+
+// Le pixel fait-il partie du sous-ensemble tracé à cette frame ?
+bool isTracedPixel(ivec2 pixel) {
+    if (interleaveCount <= 1) return true;
+    // Blocs 2x2 : les deux diagonales en alternance, pour couvrir le bloc au plus vite
+    const int quadOrder[4] = int[](0, 2, 3, 1);
+    int index = (interleaveCount == 2) ? ((pixel.x + pixel.y) & 1) : quadOrder[(pixel.x & 1) + 2 * (pixel.y & 1)];
+    return index == interleavePhase;
+}
+
+// Nombre d'échantillons du pixel en mode adaptatif : part du budget
+// proportionnelle à son poids, arrondie aléatoirement pour que la somme sur
+// l'image reste égale au budget en moyenne
+int adaptiveSampleCount() {
+    ivec2 size = textureSize(sampleWeights, 0);
+    float topLevel = floor(log2(float(max(size.x, size.y))));
+    float meanWeight = textureLod(sampleWeights, vec2(0.5), topLevel).r;
+    float weight = texelFetch(sampleWeights, ivec2(gl_FragCoord.xy), 0).r;
+
+    float count = sampleBudget * weight / max(meanWeight, 1e-8);
+    count = floor(count + random(vec3(gl_FragCoord.xy, frameSeed), 7.31));
+    return int(clamp(count, 0.0, float(ADAPTIVE_MAX_SAMPLES)));
+}
+
+#ifndef WATER_TRAVERSAL_CHECK
 void main() {
     vec3 color = vec3(0.0);
-    
-    // Anti-aliasing: multiplier les échantillons par pixel
-    float sqrtSamples = sqrt(float(MAX_SAMPLES));
-    float strataSize = 1.0 / sqrtSamples;
+    vec4 normalDepth = vec4(0.0);
+    float material = 0.0;
+    vec2 moments = vec2(0.0);   // Somme de la luminance et de son carré (adaptatif)
+    vec4 pathStats = vec4(0.0);
 
-    for (int s = 0; s < MAX_SAMPLES; ++s) {
-        // Calculer le décalage du sous-pixel pour l'anti-aliasing
-        int strataX = s % int(sqrt(float(MAX_SAMPLES)));
-        int strataY = s / int(sqrt(float(MAX_SAMPLES)));
+    mat3 cam = setCamera(viewEye, viewCenter);
 
-        vec2 strata = vec2(float(strataX), float(strataY)) * strataSize;
-        vec2 inStrata = vec2(random(vec3(gl_FragCoord.xy, time), float(s) * 0.1), random(vec3(gl_FragCoord.xy, time), float(s) * 0.2));
+    // Pixel non tracé cette frame : G-buffer et reprojection seulement, la
+    // couleur est reconstruite depuis l'historique et les voisins tracés.
+    // L'indicateur w = 0 de la reprojection doit remplacer celui de la frame
+    // précédente : la passe est dessinée sans mélange (BLEND_CUSTOM)
+    if (!isTracedPixel(ivec2(gl_FragCoord.xy))) {
+        vec2 uv = (gl_FragCoord.xy * 2.0 - resolution.xy) / resolution.y;
+        traceFirstHit(viewEye, cam * normalize(vec3(uv, 1.5)), normalDepth, material);
+        finalColor = vec4(0.0, 0.0, 0.0, 1.0);
+        gbufferPathStats = vec4(0.0);
+        gbufferNormalDepth = normalDepth;
+        gbufferMaterial = material;
+        gbufferReprojection = reprojectPixel(cam, normalDepth);
+        return;
+    }
 
-        vec2 jitter = strata + inStrata * strataSize - 0.5;
+    int sampleCount = (adaptiveSampling != 0) ? adaptiveSampleCount() : MAX_SAMPLES;
+    // Premier échantillon de la frame dans la suite du pixel. Nombre fixe par
+    // frame : rang de la frame (un pixel n'est tracé qu'une frame sur
+    // interleaveCount, sa suite reste contiguë). Nombre adaptatif, variable
+    // d'une frame à l'autre : total déjà accumulé par le pixel.
+    uint sampleBase = uint(frameIndex / max(interleaveCount, 1)) * uint(MAX_SAMPLES);
+    if (adaptiveSampling != 0) sampleBase = uint(texelFetch(sampleWeights, ivec2(gl_FragCoord.xy), 0).g);
+    
+    // Anti-aliasing: multiplier les échantillons par pixel
+    // Les échantillons d'une frame suivent ceux de la précédente dans la suite
+    // de Sobol : la stratification vaut aussi pour le TAA et l'accumulation
+    for (int s = 0; s < sampleCount; ++s) {
+        beginSample(ivec2(gl_FragCoord.xy), sampleBase + uint(s));
+
+        // Décalage du sous-pixel (déjà stratifié par la suite de Sobol)
+        vec2 jitter = sample2D(SAMPLE_DIM_CAMERA) - 0.5;
         
         vec2 uv = ((gl_FragCoord.xy + jitter) * 2.0 - resolution.xy) / resolution.y;
         
-        // Mise en place de la caméra
-        mat3 cam = setCamera(viewEye, viewCenter);
+        // Rayon primaire
         vec3 rd = cam * normalize(vec3(uv, 1.5));
         vec3 ro = viewEye;
         
-        // Seed pour le générateur de nombres aléatoires
-        float seed = float(s) + random(vec3(gl_FragCoord.xy, 0.0), time);
-        
         // Tracer le rayon
-        color += trace(ro, rd, seed);
+        // Le G-buffer est celui du premier échantillon
+        vec4 sampleNormalDepth;
+        float sampleMaterial;
+        int pathLength;
+        int pathEnd;
+        vec3 sampleColor = trace(ro, rd, sampleNormalDepth, sampleMaterial, pathLength, pathEnd);
+        pathStats += vec4(float(pathLength), 1.0, float(pathEnd == PATH_END_ROULETTE), float(pathEnd == PATH_END_DEPTH));
+        float luminance = dot(sampleColor, vec3(0.2126, 0.7152, 0.0722));
+        color += sampleColor;
+        moments += vec2(luminance, luminance * luminance);
+        if (s == 0) {
+            normalDepth = sampleNormalDepth;
+            material = sampleMaterial;
+        }
     }
     
-    // Moyenne des échantillons
-    color /= float(MAX_SAMPLES);
+    gbufferNormalDepth = normalDepth;
+    gbufferMaterial = material;
+    gbufferReprojection = reprojectPixel(cam, normalDepth);
+    gbufferReprojection.w = 1.0;
+    // Moyennes du pixel, pondérées par l'alpha : un pixel tracé écrit 1, ses
+    // valeurs ne dépendent donc pas d'un éventuel mélange
+    gbufferPathStats = (pathStats.y > 0.0) ? vec4(pathStats.x, pathStats.z, pathStats.w, pathStats.y) / pathStats.y : vec4(0.0);
+
+    // Accumulation progressive : sommes brutes et nombre d'échantillons, la
+    // moyenne, le tone mapping et la vignette sont appliqués à la résolution
+    // (progressive.fs). L'attachement 1 reçoit alors les moments de luminance.
+    if (linearOutput != 0) {
+        finalColor = vec4(color, float(sampleCount));
+        gbufferNormalDepth = vec4(moments, 0.0, 0.0);
+        return;
+    }
+
+    // Moyenne des échantillons (un pixel adaptatif peut n'en recevoir aucun)
+    color /= float(max(sampleCount, 1));
     
     // Tone mapping (ACES)
     const float a = 2.51;
@@ -893,4 +1556,63 @@ void main() {
     vec3 prevColor = texture(previousFrame, gl_FragCoord.xy / resolution.xy).rgb;
     color = mix(color, prevColor, frameBlend);
     finalColor = vec4(color, 1.0);
-}
\ No newline at end of file
+}
+#else
+// Vérification du parcours de la surface (main --water-check) : chaque pixel
+// lance un rayon rasant (pente de 0,5 à 8 degrés selon y, azimut selon x) au
+// travers du champ lié, et compare son premier impact à celui d'une marche
+// régulière au huitième de texel. Sortie : échec (r), impact trouvé par le
+// parcours (g), par la marche (b).
+#define WATER_CHECK_SUBSTEPS 8
+
+void main() {
+    vec2 q = gl_FragCoord.xy / resolution;
+    vec2 dir = vec2(cos(q.x * 6.2831853), sin(q.x * 6.2831853));
+    float slope = tan(radians(mix(0.5, 8.0, q.y)));
+    vec3 rd = normalize(vec3(dir.x, -slope, dir.y));
+
+    // Départ hors de la zone, décalé latéralement, descendant dans la tranche
+    // des vagues à peu près à l'entrée de la zone
+    int size = textureSize(waterBounds, 0).x;
+    int topLevel = int(round(log2(float(size))));
+    vec2 global = texelFetch(waterBounds, ivec2(0), topLevel).rg;
+    vec2 center = waterFieldRegion.xy + 0.5 * waterFieldRegion.z;
+    float lateral = (fract(dot(gl_FragCoord.xy, vec2(0.618034, 0.414214))) - 0.5) * 0.5 * waterFieldRegion.z;
+    vec2 start = center - dir * waterFieldRegion.z + vec2(-dir.y, dir.x) * lateral;
+    vec3 ro = vec3(start.x, global.y + slope * 0.5 * waterFieldRegion.z, start.y);
+
+    float tTraversal;
+    bool found = intersectWaterSurface(ro, rd, 0.0, 0.0, 1e4, tTraversal);
+
+    // Marche régulière sur la zone du champ
+    vec2 invDir = 1.0 / rd.xz;
+    vec2 r0 = (waterFieldRegion.xy - ro.xz) * invDir;
+    vec2 r1 = (waterFieldRegion.xy + waterFieldRegion.z - ro.xz) * invDir;
+    float tIn = max(max(min(r0.x, r1.x), min(r0.y, r1.y)), 0.0);
+    float tOut = min(max(r0.x, r1.x), max(r0.y, r1.y));
+    float texel = waterFieldRegion.z / float(size) / length(rd.xz);
+    float dt = texel / float(WATER_CHECK_SUBSTEPS);
+
+    bool marched = false;
+    float tReference = tOut;
+    float t = tIn;
+    float f = waterSurfaceError(ro, rd, 0.0, t);
+    for (int i = 0; i < 2 * WATER_CHECK_SUBSTEPS * WATER_FIELD_SIZE && t < tOut; i++) {
+        float tn = min(t + dt, tOut);
+        float fn = waterSurfaceError(ro, rd, 0.0, tn);
+        if (f * fn <= 0.0) {
+            tReference = solveWaterTexel(ro, rd, 0.0, t, tn, f, fn);
+            marched = true;
+            break;
+        }
+        t = tn;
+        f = fn;
+    }
+
+    // Échec : impact manqué ou trouvé plus d'un texel trop loin, ou point
+    // retourné qui n'est pas sur la surface
+    bool failed = marched && (!found || tTraversal > tReference + texel);
+    if (found && abs(waterSurfaceError(ro, rd, 0.0, tTraversal)) > 0.001) failed = true;
+    finalColor = vec4(failed ? 1.0 : 0.0, found ? 1.0 : 0.0, marched ? 1.0 : 0.0, 1.0);
+}
+#endif
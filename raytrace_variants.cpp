@@ -0,0 +1,139 @@
+#include "raytrace_variants.h"
+#include "scene_storage.h"
+#include "bvh.h"
+#include "blue_noise.h"
+#include "light_list.h"
+#include "water_field.h"
+#include "water_bounds.h"
+#include <string.h>
+#include <stdio.h>
+
+static const QualityTierDesc qualityTiers[QUALITY_TIER_COUNT] = {
+    { "preview", 1, 2 },
+    { "interactive", 2, 3 },
+    { "final", 16, 8 },
+};
+
+const QualityTierDesc *GetQualityTier(int tier) {
+    if ((tier < 0) || (tier >= QUALITY_TIER_COUNT)) return NULL;
+    return &qualityTiers[tier];
+}
+
+int FindQualityTier(const char *name) {
+    for (int i = 0; i < QUALITY_TIER_COUNT; i++) {
+        if (strcmp(qualityTiers[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Insère des #define juste après la ligne #version (qui doit rester la première)
+static char *InjectShaderDefines(const char *source, const char *defines) {
+    const char *body = source;
+    if (strncmp(source, "#version", 8) == 0) {
+        const char *eol = strchr(source, '\n');
+        body = (eol != NULL) ? eol + 1 : source + strlen(source);
+    }
+
+    size_t headerLength = (size_t)(body - source);
+    size_t definesLength = strlen(defines);
+    size_t bodyLength = strlen(body);
+
+    char *code = (char *)MemAlloc((unsigned int)(headerLength + definesLength + bodyLength + 2));
+    memcpy(code, source, headerLength);
+    // #version sans retour à la ligne en fin de fichier
+    if ((headerLength > 0) && (source[headerLength - 1] != '\n')) code[headerLength++] = '\n';
+    memcpy(code + headerLength, defines, definesLength);
+    memcpy(code + headerLength + definesLength, body, bodyLength + 1);
+    return code;
+}
+
+static char *InjectQualityDefines(const char *source, const QualityTierDesc *desc) {
+    char defines[128];
+    snprintf(defines, sizeof(defines), "#define MAX_SAMPLES %i\n#define MAX_BOUNCES %i\n", desc->samples, desc->bounces);
+    return InjectShaderDefines(source, defines);
+}
+
+Shader LoadShaderWithDefines(const char *fileName, const char *defines) {
+    Shader shader = { 0 };
+    char *source = LoadFileText(fileName);
+    if (source == NULL) return shader;
+
+    char *code = InjectShaderDefines(source, defines);
+    shader = LoadShaderFromMemory(0, code);
+    MemFree(code);
+    UnloadFileText(source);
+    return shader;
+}
+
+bool LoadRaytraceVariants(RaytraceVariants *variants, const char *fileName, float width, float height) {
+    char *source = LoadFileText(fileName);
+    if (source == NULL) return false;
+
+    Shader shaders[QUALITY_TIER_COUNT] = { 0 };
+    bool success = true;
+    for (int i = 0; i < QUALITY_TIER_COUNT; i++) {
+        char *code = InjectQualityDefines(source, &qualityTiers[i]);
+        shaders[i] = LoadShaderFromMemory(0, code);
+        MemFree(code);
+
+        if (!IsShaderValid(shaders[i])) {
+            TraceLog(LOG_WARNING, "SHADER: Échec de la permutation '%s' de %s", qualityTiers[i].name, fileName);
+            success = false;
+            break;
+        }
+    }
+    UnloadFileText(source);
+
+    if (!success) {
+        for (int i = 0; i < QUALITY_TIER_COUNT; i++) {
+            if (IsShaderValid(shaders[i])) UnloadShader(shaders[i]);
+        }
+        return false;
+    }
+
+    for (int i = 0; i < QUALITY_TIER_COUNT; i++) {
+        if (IsShaderValid(variants->shaders[i])) UnloadShader(variants->shaders[i]);
+        variants->shaders[i] = shaders[i];
+
+        // Réglages qui ne changent pas d'une frame à l'autre, faits une fois par programme
+        ResolveSceneUniforms(&variants->uniforms[i], shaders[i]);
+        SetSceneResolution(&variants->uniforms[i], width, height);
+        BindSceneStorageSamplers(shaders[i]);
+        BindBvhSamplers(shaders[i]);
+        BindBlueNoiseSampler(shaders[i]);
+        BindLightListSampler(shaders[i]);
+        BindWaterFieldSampler(shaders[i]);
+        BindWaterBoundsSampler(shaders[i]);
+    }
+
+    return true;
+}
+
+void UnloadRaytraceVariants(RaytraceVariants *variants) {
+    for (int i = 0; i < QUALITY_TIER_COUNT; i++) {
+        if (IsShaderValid(variants->shaders[i])) UnloadShader(variants->shaders[i]);
+        variants->shaders[i] = (Shader){ 0 };
+    }
+}
+
+void WarmUpRaytraceVariants(const RaytraceVariants *variants, RenderTexture2D target) {
+    BeginTextureMode(target);
+    for (int i = 0; i < QUALITY_TIER_COUNT; i++) {
+        BeginShaderMode(variants->shaders[i]);
+            DrawRectangle(0, 0, 1, 1, WHITE);
+        EndShaderMode();
+    }
+    EndTextureMode();
+}
+
+void SetRaytraceResolution(const RaytraceVariants *variants, float width, float height) {
+    for (int i = 0; i < QUALITY_TIER_COUNT; i++) SetSceneResolution(&variants->uniforms[i], width, height);
+}
+
+Shader GetRaytraceShader(const RaytraceVariants *variants) {
+    return variants->shaders[variants->current];
+}
+
+const SceneUniforms *GetRaytraceUniforms(const RaytraceVariants *variants) {
+    return &variants->uniforms[variants->current];
+}
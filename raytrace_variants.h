@@ -0,0 +1,57 @@
+#ifndef RAYTRACE_VARIANTS_H
+#define RAYTRACE_VARIANTS_H
+
+#include "raylib.h"
+#include "scene_uniforms.h"
+
+// Niveaux de qualité du raytracing : chacun est une permutation de raytest.fs
+// compilée avec ses propres MAX_SAMPLES / MAX_BOUNCES
+typedef enum {
+    QUALITY_PREVIEW = 0,
+    QUALITY_INTERACTIVE,
+    QUALITY_FINAL,
+    QUALITY_TIER_COUNT
+} QualityTier;
+
+typedef struct {
+    const char *name;
+    int samples;    // MAX_SAMPLES (échantillons par pixel)
+    int bounces;    // MAX_BOUNCES
+} QualityTierDesc;
+
+// Cache des programmes compilés, un par niveau. Tous sont compilés (et
+// préchauffés) au chargement : changer de niveau ne fait qu'échanger le
+// programme courant, sans compilation pendant le rendu.
+typedef struct {
+    Shader shaders[QUALITY_TIER_COUNT];
+    SceneUniforms uniforms[QUALITY_TIER_COUNT];   // Emplacements résolus par programme
+    int current;                                  // Niveau utilisé pour le rendu
+} RaytraceVariants;
+
+const QualityTierDesc *GetQualityTier(int tier);
+
+// Niveau correspondant à un nom ("preview", "interactive", "final"), -1 si inconnu
+int FindQualityTier(const char *name);
+
+// Compilation de toutes les permutations de fileName. En cas d'échec d'une seule
+// d'entre elles, rien n'est remplacé et la fonction retourne false (le cache
+// précédent reste utilisable, utile pour le rechargement à chaud).
+bool LoadRaytraceVariants(RaytraceVariants *variants, const char *fileName, float width, float height);
+void UnloadRaytraceVariants(RaytraceVariants *variants);
+
+// Dessine un pixel avec chaque programme dans target : les pilotes finalisent
+// souvent la compilation au premier draw, qui est ainsi fait hors de la boucle
+void WarmUpRaytraceVariants(const RaytraceVariants *variants, RenderTexture2D target);
+
+// Résolution transmise à tous les programmes du cache
+void SetRaytraceResolution(const RaytraceVariants *variants, float width, float height);
+
+// Compilation de fileName avec des #define supplémentaires (permutations de
+// vérification, comme WATER_TRAVERSAL_CHECK)
+Shader LoadShaderWithDefines(const char *fileName, const char *defines);
+
+// Programme et emplacements du niveau courant
+Shader GetRaytraceShader(const RaytraceVariants *variants);
+const SceneUniforms *GetRaytraceUniforms(const RaytraceVariants *variants);
+
+#endif // RAYTRACE_VARIANTS_H
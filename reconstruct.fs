@@ -0,0 +1,78 @@
+#version 330 core
+
+// Reconstruction du tracé entrelacé : les pixels tracés cette frame sont
+// recopiés, les autres reprennent l'historique reprojeté (borné par les voisins
+// tracés) ou, après une désocclusion, la moyenne bilatérale des voisins tracés.
+
+in vec2 fragTexCoord;
+out vec4 fragColor;
+
+uniform sampler2D renderNoisy;         // sortie couleur de raytest.fs (pixels non tracés à zéro)
+uniform sampler2D renderNormals;       // normales + profondeur linéaire dans alpha
+uniform sampler2D renderMaterial;      // type de matériau + 1 (0 = ciel)
+uniform sampler2D renderReprojection;  // déplacement vers la frame précédente, validité (z), pixel tracé (w)
+uniform sampler2D renderHistory;       // frame précédente (sortie du TAA, résolution de sortie)
+
+uniform vec2 resolution;
+uniform vec2 renderScale;      // Part des textures rendue (résolution dynamique), 1 = pleine résolution
+
+#define DEPTH_PHI 0.05      // Écart de profondeur toléré, relatif à la profondeur du pixel
+#define NORMAL_PHI 16.0     // Exposant sur dot(n, n')
+
+void main() {
+    vec2 uv = fragTexCoord;
+    vec2 pixel = 1.0 / resolution;
+
+    vec4 center = texture(renderNoisy, uv);
+    vec4 motion = texture(renderReprojection, uv);
+    if (motion.w > 0.5) {
+        fragColor = center;
+        return;
+    }
+
+    vec4 nzval = texture(renderNormals, uv);
+    float mval = texture(renderMaterial, uv).r;
+
+    // Voisins tracés du 3x3 (au moins deux, en damier comme en blocs 2x2)
+    vec3 sum = vec3(0.0);
+    float cum_w = 0.0;
+    vec3 plainSum = vec3(0.0);
+    float plainCount = 0.0;
+    vec3 minColor = vec3(1e9);
+    vec3 maxColor = vec3(-1e9);
+
+    for (int i = -1; i <= 1; ++i) {
+        for (int j = -1; j <= 1; ++j) {
+            vec2 tc = clamp(uv + vec2(i, j) * pixel, 0.5 * pixel, renderScale - 0.5 * pixel);
+            if (texture(renderReprojection, tc).w < 0.5) continue;
+
+            vec3 ctmp = texture(renderNoisy, tc).rgb;
+            vec4 nztmp = texture(renderNormals, tc);
+            float mtmp = texture(renderMaterial, tc).r;
+
+            float n_w = (mval == 0.0) ? 1.0 : pow(max(dot(nztmp.rgb, nzval.rgb), 0.0), NORMAL_PHI);
+            float r_w = exp(-abs(nztmp.a - nzval.a) / (DEPTH_PHI * nzval.a + 1e-4));
+            float m_w = (mtmp == mval) ? 1.0 : 0.0;
+
+            float weight = n_w * r_w * m_w;
+            sum += ctmp * weight;
+            cum_w += weight;
+            plainSum += ctmp;
+            plainCount += 1.0;
+            minColor = min(minColor, ctmp);
+            maxColor = max(maxColor, ctmp);
+        }
+    }
+
+    // Aucun voisin de la même surface (arête fine) : simple moyenne
+    vec3 spatial = (cum_w > 1e-4) ? sum / cum_w : plainSum / max(plainCount, 1.0);
+
+    // Historique au point reprojeté, borné par les voisins pour limiter le ghosting
+    vec3 color = spatial;
+    if (motion.z > 0.5 && plainCount > 0.0) {
+        vec3 hist = texture(renderHistory, uv / renderScale + motion.xy).rgb;
+        color = clamp(hist, minColor, maxColor);
+    }
+
+    fragColor = vec4(color, 1.0);
+}
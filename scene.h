@@ -0,0 +1,79 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "raylib.h"
+#include "wave_sources.h"
+#include <stddef.h>
+
+// Structure pour les sphères
+typedef struct {
+    Vector3 position;
+    float radius;
+} Sphere;
+
+//structure pour les blocs (murs)
+typedef struct {
+    Vector3 position;
+    Vector3 size; // Taille du bloc (largeur, hauteur, profondeur)
+} Block;
+
+// Structure pour les matériaux
+typedef struct {
+    int type;         // 0 = diffus, 1 = métallique, 2 = verre, 3 = emissif 4 = mirroir 5 = zone_emition 6 = eau
+    float roughness;  // 0.0 - 1.0
+    float ior;        // indice de réfraction (verre)
+    float padding;    // pour alignement
+    Vector3 albedo;   // couleur
+    float padding2;   // pour alignement
+} Material2;
+
+// vec3 dans un tableau std140 / un texel RGBA32F : pas de 16 octets
+typedef struct {
+    Vector3 v;
+    float padding;
+} Vec3Std140;
+
+// Miroir C++ du bloc uniforme std140 "SceneBlock" de raytest.fs : paramètres
+// globaux de la scène (lumière, faisceau, vagues, nombre de primitives).
+// Les primitives elles-mêmes sont dans des texture buffers (scene_storage.h).
+// L'ordre et le remplissage des champs suivent exactement les règles std140 :
+// un vec3 est aligné sur 16 octets et peut être suivi d'un scalaire.
+typedef struct {
+    Vector3 lightPos;      float lightIntensity;
+    Vector3 lightColor;    int sphereCount;
+    Vector3 beamDirection; float beamAngle;
+    Vector3 beamPosition;  float beamIntensity;
+    Vector3 beamColor;     int enableBeam;
+    Vector3 waveCenter;    int enableWaves;
+    float waveDuration;
+    float waveAmplitude;
+    float waveStartTime;
+    float waveDecayRate;
+    int blockCount;
+    int bvhNodeCount;      // 0 : pas de BVH, le shader parcourt toutes les primitives
+    int lightCount;        // Entrées de la table des sources (light_list.h)
+    float lightTotalPower; // Puissance totale des sources (probabilité de tirage de chacune)
+    // Budget de rebonds par type de matériau (ivec4[2] en GLSL) : roulette russe
+    // à partir de la profondeur minimale, arrêt à la maximale (0 = MAX_BOUNCES,
+    // -1 = PATH_DEPTH_LIMIT, soit 2 x MAX_BOUNCES)
+    int materialMinDepth[8];
+    int materialMaxDepth[8];
+    int waveSourceCount;   // Sources de vagues vivantes (wave_sources.h)
+    int padding[3];        // vec4 suivant aligné sur 16 octets
+    WaveSource waveSources[WAVE_SOURCE_MAX];
+} SceneBlock;
+
+// Vérification du layout à la compilation (doit correspondre au std140 de raytest.fs)
+static_assert(sizeof(Material2) == 32, "Material2 doit faire 32 octets (struct Material std140)");
+static_assert(offsetof(Material2, albedo) == 16, "Material2.albedo doit être aligné sur 16 octets");
+static_assert(sizeof(Vec3Std140) == 16, "vec3 en tableau std140 : pas de 16 octets");
+static_assert(offsetof(SceneBlock, lightIntensity) == 12, "float après vec3 std140");
+static_assert(offsetof(SceneBlock, waveDuration) == 96, "SceneBlock.waveDuration mal aligné");
+static_assert(offsetof(SceneBlock, blockCount) == 112, "SceneBlock.blockCount mal aligné");
+static_assert(offsetof(SceneBlock, bvhNodeCount) == 116, "SceneBlock.bvhNodeCount mal aligné");
+static_assert(offsetof(SceneBlock, lightCount) == 120, "SceneBlock.lightCount mal aligné");
+static_assert(offsetof(SceneBlock, materialMinDepth) == 128, "SceneBlock.materialMinDepth mal aligné");
+static_assert(offsetof(SceneBlock, waveSources) == 208, "SceneBlock.waveSources mal aligné");
+static_assert(sizeof(SceneBlock) == 208 + 16*WAVE_SOURCE_MAX, "SceneBlock : taille std140 inattendue");
+
+#endif // SCENE_H
@@ -0,0 +1,244 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "scene_storage.h"
+#include <string.h>
+
+void MarkSceneTextureBufferDirty(SceneTextureBuffer *tb, int index) {
+    if (tb->dirtyMin > tb->dirtyMax) {
+        tb->dirtyMin = index;
+        tb->dirtyMax = index;
+    } else {
+        if (index < tb->dirtyMin) tb->dirtyMin = index;
+        if (index > tb->dirtyMax) tb->dirtyMax = index;
+    }
+}
+
+static void ClearDirty(SceneTextureBuffer *tb) {
+    tb->dirtyMin = 1;
+    tb->dirtyMax = 0;
+}
+
+void InvalidateSceneTextureBuffer(SceneTextureBuffer *tb) {
+    tb->reallocate = true;
+}
+
+void LoadSceneTextureBuffer(SceneTextureBuffer *tb, int internalFormat, int textureUnit) {
+    glGenBuffers(1, &tb->bufferId);
+    glGenTextures(1, &tb->textureId);
+    tb->internalFormat = internalFormat;
+    tb->textureUnit = textureUnit;
+    tb->capacity = 0;
+    tb->reallocate = true;
+    ClearDirty(tb);
+}
+
+void UnloadSceneTextureBuffer(SceneTextureBuffer *tb) {
+    if (tb->textureId != 0) glDeleteTextures(1, &tb->textureId);
+    if (tb->bufferId != 0) glDeleteBuffers(1, &tb->bufferId);
+    tb->textureId = 0;
+    tb->bufferId = 0;
+    tb->capacity = 0;
+}
+
+// Envoie la plage modifiée (ou tout le buffer s'il doit être agrandi).
+// Retourne le nombre d'octets envoyés.
+unsigned int UploadSceneTextureBuffer(SceneTextureBuffer *tb, const void *data, unsigned int count, unsigned int recordSize) {
+    unsigned int uploaded = 0;
+
+    if (tb->reallocate || count > tb->capacity) {
+        // Agrandissement par puissances de 2 pour amortir les ajouts successifs
+        unsigned int capacity = (tb->capacity > 0) ? tb->capacity : 64;
+        while (capacity < count) capacity *= 2;
+
+        int texelSize = (tb->internalFormat == GL_RGBA32F) ? 16 : 4;
+        int maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        if ((long long)capacity*(recordSize/texelSize) > (long long)maxTexels) {
+            TraceLog(LOG_WARNING, "SCENE: %u enregistrements dépassent GL_MAX_TEXTURE_BUFFER_SIZE (%i texels)", count, maxTexels);
+        }
+
+        glBindBuffer(GL_TEXTURE_BUFFER, tb->bufferId);
+        glBufferData(GL_TEXTURE_BUFFER, capacity*recordSize, NULL, GL_DYNAMIC_DRAW);
+        if (count > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, count*recordSize, data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        // (Re)liaison du buffer à sa texture, sur une unité que raylib ne touche pas
+        glActiveTexture(GL_TEXTURE0 + tb->textureUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, tb->textureId);
+        glTexBuffer(GL_TEXTURE_BUFFER, tb->internalFormat, tb->bufferId);
+        glActiveTexture(GL_TEXTURE0);
+
+        tb->capacity = capacity;
+        tb->reallocate = false;
+        uploaded = count*recordSize;
+    } else if (tb->dirtyMin <= tb->dirtyMax) {
+        unsigned int offset = tb->dirtyMin*recordSize;
+        unsigned int length = (tb->dirtyMax - tb->dirtyMin + 1)*recordSize;
+        glBindBuffer(GL_TEXTURE_BUFFER, tb->bufferId);
+        glBufferSubData(GL_TEXTURE_BUFFER, offset, length, (const unsigned char *)data + offset);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        uploaded = length;
+    }
+
+    ClearDirty(tb);
+    return uploaded;
+}
+
+unsigned int UploadSceneTextureBufferRecords(SceneTextureBuffer *tb, const void *data, const int *indices, int indexCount, unsigned int recordSize) {
+    glBindBuffer(GL_TEXTURE_BUFFER, tb->bufferId);
+    for (int i = 0; i < indexCount; i++) {
+        unsigned int offset = indices[i]*recordSize;
+        glBufferSubData(GL_TEXTURE_BUFFER, offset, recordSize, (const unsigned char *)data + offset);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    return indexCount*recordSize;
+}
+
+void InitSceneStorage(SceneStorage *storage) {
+    storage->spheres.clear();
+    storage->blocks.clear();
+    LoadSceneTextureBuffer(&storage->sphereBuffer, GL_RGBA32F, SCENE_SPHERE_TEXTURE_UNIT);
+    LoadSceneTextureBuffer(&storage->blockBuffer, GL_RGBA32F, SCENE_BLOCK_TEXTURE_UNIT);
+    storage->uploadedBytes = 0;
+    storage->version = 0;
+    storage->layoutVersion = 0;
+    storage->emitterVersion = 0;
+    storage->movedSpheres.clear();
+    storage->movedBlocks.clear();
+}
+
+void UnloadSceneStorage(SceneStorage *storage) {
+    UnloadSceneTextureBuffer(&storage->sphereBuffer);
+    UnloadSceneTextureBuffer(&storage->blockBuffer);
+    storage->spheres.clear();
+    storage->blocks.clear();
+}
+
+int AddSceneSphere(SceneStorage *storage, Sphere sphere, Material2 material) {
+    SphereRecord record = { sphere, material };
+    storage->spheres.push_back(record);
+    int index = (int)storage->spheres.size() - 1;
+    MarkSceneTextureBufferDirty(&storage->sphereBuffer, index);
+    storage->version++;
+    storage->layoutVersion++;
+    storage->emitterVersion++;
+    return index;
+}
+
+int AddSceneBlock(SceneStorage *storage, Block block, Material2 material) {
+    BlockRecord record;
+    memset(&record, 0, sizeof(record));
+    record.position.v = block.position;
+    record.size.v = block.size;
+    record.material = material;
+    storage->blocks.push_back(record);
+    int index = (int)storage->blocks.size() - 1;
+    MarkSceneTextureBufferDirty(&storage->blockBuffer, index);
+    storage->version++;
+    storage->layoutVersion++;
+    storage->emitterVersion++;
+    return index;
+}
+
+void SetSceneSphere(SceneStorage *storage, int index, Sphere sphere) {
+    SphereRecord *record = &storage->spheres[index];
+    if (memcmp(&record->sphere, &sphere, sizeof(Sphere)) == 0) return;
+    if (record->sphere.radius != sphere.radius) storage->emitterVersion++;
+    record->sphere = sphere;
+    MarkSceneTextureBufferDirty(&storage->sphereBuffer, index);
+    storage->movedSpheres.push_back(index);
+    storage->version++;
+}
+
+void SetSceneSphereMaterial(SceneStorage *storage, int index, Material2 material) {
+    SphereRecord *record = &storage->spheres[index];
+    if (memcmp(&record->material, &material, sizeof(Material2)) == 0) return;
+    record->material = material;
+    MarkSceneTextureBufferDirty(&storage->sphereBuffer, index);
+    storage->version++;
+    storage->emitterVersion++;
+}
+
+void SetSceneBlock(SceneStorage *storage, int index, Block block) {
+    BlockRecord *record = &storage->blocks[index];
+    if (memcmp(&record->position.v, &block.position, sizeof(Vector3)) == 0 &&
+        memcmp(&record->size.v, &block.size, sizeof(Vector3)) == 0) return;
+    if (memcmp(&record->size.v, &block.size, sizeof(Vector3)) != 0) storage->emitterVersion++;
+    record->position.v = block.position;
+    record->size.v = block.size;
+    MarkSceneTextureBufferDirty(&storage->blockBuffer, index);
+    storage->movedBlocks.push_back(index);
+    storage->version++;
+}
+
+void ClearSceneStorage(SceneStorage *storage) {
+    storage->spheres.clear();
+    storage->blocks.clear();
+    ClearDirty(&storage->sphereBuffer);
+    ClearDirty(&storage->blockBuffer);
+    storage->movedSpheres.clear();
+    storage->movedBlocks.clear();
+    storage->version++;
+    storage->layoutVersion++;
+    storage->emitterVersion++;
+}
+
+unsigned int UploadSceneStorage(SceneStorage *storage) {
+    unsigned int uploaded = 0;
+    uploaded += UploadSceneTextureBuffer(&storage->sphereBuffer, storage->spheres.data(),
+                                         (unsigned int)storage->spheres.size(), sizeof(SphereRecord));
+    uploaded += UploadSceneTextureBuffer(&storage->blockBuffer, storage->blocks.data(),
+                                         (unsigned int)storage->blocks.size(), sizeof(BlockRecord));
+    storage->uploadedBytes = uploaded;
+    return uploaded;
+}
+
+void BindSceneStorageSamplers(Shader shader) {
+    int sphereUnit = SCENE_SPHERE_TEXTURE_UNIT;
+    int blockUnit = SCENE_BLOCK_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "sceneSpheres"), &sphereUnit, SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "sceneBlocks"), &blockUnit, SHADER_UNIFORM_INT);
+}
+
+// Générateur pseudo-aléatoire simple (xorshift) pour une scène reproductible
+static float RandomUnit(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return (float)(x & 0xFFFFFF)/(float)0x1000000;
+}
+
+void GenerateStressScene(SceneStorage *storage, int sphereCount, int blockCount, unsigned int seed) {
+    unsigned int state = (seed != 0) ? seed : 0x9E3779B9u;
+
+    // Répartition sur une grille carrée au-dessus de l'eau, avec un léger désordre
+    int total = sphereCount + blockCount;
+    int side = 1;
+    while (side*side < total) side++;
+    const float spacing = 1.5f;
+    const float origin = -0.5f*spacing*(float)(side - 1);
+
+    for (int i = 0; i < total; i++) {
+        float x = origin + spacing*(float)(i % side) + (RandomUnit(&state) - 0.5f)*0.5f;
+        float z = origin + spacing*(float)(i / side) + (RandomUnit(&state) - 0.5f)*0.5f;
+        float y = 0.5f + RandomUnit(&state)*3.0f;
+
+        Material2 material = { 0 };
+        float pick = RandomUnit(&state);
+        material.type = (pick < 0.6f) ? 0 : (pick < 0.85f) ? 1 : 2;   // diffus, métal, verre
+        material.roughness = RandomUnit(&state)*0.5f;
+        material.ior = (material.type == 2) ? 1.5f : 1.0f;
+        material.albedo = (Vector3){ 0.2f + 0.8f*RandomUnit(&state), 0.2f + 0.8f*RandomUnit(&state), 0.2f + 0.8f*RandomUnit(&state) };
+
+        if (i < sphereCount) {
+            Sphere sphere = { { x, y, z }, 0.2f + 0.4f*RandomUnit(&state) };
+            AddSceneSphere(storage, sphere, material);
+        } else {
+            float s = 0.3f + 0.6f*RandomUnit(&state);
+            Block block = { { x, y, z }, { s, s*(0.5f + RandomUnit(&state)), s } };
+            AddSceneBlock(storage, block, material);
+        }
+    }
+}
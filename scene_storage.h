@@ -0,0 +1,92 @@
+#ifndef SCENE_STORAGE_H
+#define SCENE_STORAGE_H
+
+#include "raylib.h"
+#include "scene.h"
+#include <vector>
+
+// Unités de texture réservées aux buffers de la scène (raylib n'utilise que les premières)
+#define SCENE_SPHERE_TEXTURE_UNIT 8
+#define SCENE_BLOCK_TEXTURE_UNIT 9
+
+// Enregistrement d'une sphère dans le texture buffer (3 texels RGBA32F) :
+// texel 0 = position + rayon, texels 1-2 = Material2 (type lu avec floatBitsToInt)
+typedef struct {
+    Sphere sphere;
+    Material2 material;
+} SphereRecord;
+
+// Enregistrement d'un bloc dans le texture buffer (4 texels RGBA32F) :
+// texel 0 = centre, texel 1 = taille, texels 2-3 = Material2
+typedef struct {
+    Vec3Std140 position;
+    Vec3Std140 size;
+    Material2 material;
+} BlockRecord;
+
+static_assert(sizeof(SphereRecord) == 3*16, "SphereRecord doit faire 3 texels RGBA32F");
+static_assert(sizeof(BlockRecord) == 4*16, "BlockRecord doit faire 4 texels RGBA32F");
+
+// Texture buffer (TBO) : un buffer GL vu comme samplerBuffer par le shader
+typedef struct {
+    unsigned int bufferId;
+    unsigned int textureId;
+    int internalFormat;     // Format des texels (GL_RGBA32F, GL_R32I, ...)
+    int textureUnit;        // Unité de texture sur laquelle il reste lié
+    unsigned int capacity;  // Nombre d'enregistrements alloués côté GPU
+    int dirtyMin;           // Plage d'enregistrements modifiés depuis le dernier envoi
+    int dirtyMax;           // (dirtyMin > dirtyMax : rien à envoyer)
+    bool reallocate;        // Le buffer doit être réalloué (capacité dépassée)
+} SceneTextureBuffer;
+
+// Primitives et matériaux de la scène, stockés dans des texture buffers dont la
+// taille n'est limitée que par GL_MAX_TEXTURE_BUFFER_SIZE (et non plus par les
+// limites de composants uniformes). Le nombre d'objets est connu à l'exécution.
+typedef struct {
+    std::vector<SphereRecord> spheres;
+    std::vector<BlockRecord> blocks;
+
+    SceneTextureBuffer sphereBuffer;
+    SceneTextureBuffer blockBuffer;
+
+    unsigned int uploadedBytes;   // Octets envoyés lors du dernier UploadSceneStorage
+    unsigned int version;         // Incrémenté à chaque modification effective de la scène
+    unsigned int layoutVersion;   // Incrémenté quand des primitives sont ajoutées ou retirées
+    unsigned int emitterVersion;  // Incrémenté quand la puissance des sources peut changer (matériau, taille, ajout/retrait)
+
+    // Primitives déplacées ou redimensionnées depuis la dernière mise à jour du BVH
+    // (vidées par UpdateBvh, un index peut y figurer plusieurs fois)
+    std::vector<int> movedSpheres;
+    std::vector<int> movedBlocks;
+} SceneStorage;
+
+// Texture buffers génériques (utilisés aussi par le BVH)
+void LoadSceneTextureBuffer(SceneTextureBuffer *tb, int internalFormat, int textureUnit);
+void UnloadSceneTextureBuffer(SceneTextureBuffer *tb);
+void MarkSceneTextureBufferDirty(SceneTextureBuffer *tb, int index);
+void InvalidateSceneTextureBuffer(SceneTextureBuffer *tb);   // Tout renvoyer au prochain envoi
+unsigned int UploadSceneTextureBuffer(SceneTextureBuffer *tb, const void *data, unsigned int count, unsigned int recordSize);
+// Envoi d'enregistrements isolés (le buffer doit déjà être alloué)
+unsigned int UploadSceneTextureBufferRecords(SceneTextureBuffer *tb, const void *data, const int *indices, int indexCount, unsigned int recordSize);
+
+void InitSceneStorage(SceneStorage *storage);
+void UnloadSceneStorage(SceneStorage *storage);
+
+// Ajout et modification des primitives (les modifications sans effet ne marquent rien)
+int AddSceneSphere(SceneStorage *storage, Sphere sphere, Material2 material);
+int AddSceneBlock(SceneStorage *storage, Block block, Material2 material);
+void SetSceneSphere(SceneStorage *storage, int index, Sphere sphere);
+void SetSceneSphereMaterial(SceneStorage *storage, int index, Material2 material);
+void SetSceneBlock(SceneStorage *storage, int index, Block block);
+void ClearSceneStorage(SceneStorage *storage);
+
+// Envoi des plages modifiées vers le GPU, retourne le nombre d'octets envoyés
+unsigned int UploadSceneStorage(SceneStorage *storage);
+
+// Liaison des samplers sceneSpheres / sceneBlocks d'un shader à leurs unités de texture
+void BindSceneStorageSamplers(Shader shader);
+
+// Génère une scène de test aléatoire (sphères et boîtes au-dessus de l'eau)
+void GenerateStressScene(SceneStorage *storage, int sphereCount, int blockCount, unsigned int seed);
+
+#endif // SCENE_STORAGE_H
@@ -0,0 +1,171 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "scene_uniforms.h"
+#include "raymath.h"
+#include <string.h>
+
+void ResolveSceneUniforms(SceneUniforms *su, Shader shader) {
+    su->shader = shader;
+
+    su->viewEye = GetShaderLocation(shader, "viewEye");
+    su->viewCenter = GetShaderLocation(shader, "viewCenter");
+    su->resolution = GetShaderLocation(shader, "resolution");
+    su->time = GetShaderLocation(shader, "time");
+    su->frameSeed = GetShaderLocation(shader, "frameSeed");
+    su->frameIndex = GetShaderLocation(shader, "frameIndex");
+    su->linearOutput = GetShaderLocation(shader, "linearOutput");
+    su->adaptiveSampling = GetShaderLocation(shader, "adaptiveSampling");
+    su->sampleWeights = GetShaderLocation(shader, "sampleWeights");
+    su->sampleBudget = GetShaderLocation(shader, "sampleBudget");
+    su->previousViewProjection = GetShaderLocation(shader, "previousViewProjection");
+    su->previousNormalDepth = GetShaderLocation(shader, "previousNormalDepth");
+    su->previousRenderScale = GetShaderLocation(shader, "previousRenderScale");
+    su->interleaveCount = GetShaderLocation(shader, "interleaveCount");
+    su->interleavePhase = GetShaderLocation(shader, "interleavePhase");
+    su->waterFieldRegion = GetShaderLocation(shader, "waterFieldRegion");
+
+    // Le bloc SceneBlock est relié une fois pour toutes au point de liaison du UBO
+    GLuint index = glGetUniformBlockIndex(shader.id, "SceneBlock");
+    su->sceneBlockIndex = (index == GL_INVALID_INDEX) ? -1 : (int)index;
+    if (su->sceneBlockIndex >= 0) {
+        glUniformBlockBinding(shader.id, index, SCENE_BLOCK_BINDING);
+    } else {
+        TraceLog(LOG_WARNING, "SHADER: [ID %i] Bloc uniforme SceneBlock introuvable", shader.id);
+    }
+}
+
+void SetSceneCamera(const SceneUniforms *su, Vector3 eye, Vector3 center) {
+    SetShaderValue(su->shader, su->viewEye, &eye, SHADER_UNIFORM_VEC3);
+    SetShaderValue(su->shader, su->viewCenter, &center, SHADER_UNIFORM_VEC3);
+}
+
+void SetSceneResolution(const SceneUniforms *su, float width, float height) {
+    float resolution[2] = { width, height };
+    SetShaderValue(su->shader, su->resolution, resolution, SHADER_UNIFORM_VEC2);
+}
+
+void SetSceneTime(const SceneUniforms *su, float time) {
+    SetShaderValue(su->shader, su->time, &time, SHADER_UNIFORM_FLOAT);
+}
+
+void SetSceneFrameSeed(const SceneUniforms *su, float seed) {
+    SetShaderValue(su->shader, su->frameSeed, &seed, SHADER_UNIFORM_FLOAT);
+}
+
+void SetSceneFrameIndex(const SceneUniforms *su, int frame) {
+    SetShaderValue(su->shader, su->frameIndex, &frame, SHADER_UNIFORM_INT);
+}
+
+void SetSceneLinearOutput(const SceneUniforms *su, bool linear) {
+    int value = linear ? 1 : 0;
+    SetShaderValue(su->shader, su->linearOutput, &value, SHADER_UNIFORM_INT);
+}
+
+void SetSceneInterleave(const SceneUniforms *su, int count, int phase) {
+    SetShaderValue(su->shader, su->interleaveCount, &count, SHADER_UNIFORM_INT);
+    SetShaderValue(su->shader, su->interleavePhase, &phase, SHADER_UNIFORM_INT);
+}
+
+void SetSceneWaterField(const SceneUniforms *su, Vector2 origin, float size) {
+    float region[3] = { origin.x, origin.y, size };
+    SetShaderValue(su->shader, su->waterFieldRegion, region, SHADER_UNIFORM_VEC3);
+}
+
+void SetSceneAdaptiveSampling(const SceneUniforms *su, bool enabled, Texture2D weights, float budget) {
+    int value = enabled ? 1 : 0;
+    SetShaderValue(su->shader, su->adaptiveSampling, &value, SHADER_UNIFORM_INT);
+    if (!enabled) return;
+
+    SetShaderValue(su->shader, su->sampleBudget, &budget, SHADER_UNIFORM_FLOAT);
+    SetShaderValueTexture(su->shader, su->sampleWeights, weights);
+}
+
+void SetSceneReprojection(const SceneUniforms *su, Matrix viewProjection, Texture2D previousNormalDepth, Vector2 renderScale) {
+    SetShaderValueMatrix(su->shader, su->previousViewProjection, viewProjection);
+    SetShaderValue(su->shader, su->previousRenderScale, &renderScale, SHADER_UNIFORM_VEC2);
+    SetShaderValueTexture(su->shader, su->previousNormalDepth, previousNormalDepth);
+}
+
+Matrix GetSceneViewProjection(Vector3 eye, Vector3 center, float aspect) {
+    // Même repère que setCamera : cw vers la cible, cu à droite, cv en haut
+    Vector3 cw = Vector3Normalize(Vector3Subtract(center, eye));
+    Vector3 cu = Vector3Normalize(Vector3CrossProduct(cw, (Vector3){ 0.0f, 1.0f, 0.0f }));
+    Vector3 cv = Vector3Normalize(Vector3CrossProduct(cu, cw));
+    const float focal = 1.5f;   // vec3(uv, 1.5) dans raytest.fs, uv.y dans [-1, 1]
+
+    // Lignes : x et y projetés, z et w = profondeur le long de cw
+    Matrix m = { 0 };
+    m.m0 = cu.x*focal/aspect; m.m4 = cu.y*focal/aspect; m.m8 = cu.z*focal/aspect; m.m12 = -Vector3DotProduct(cu, eye)*focal/aspect;
+    m.m1 = cv.x*focal;        m.m5 = cv.y*focal;        m.m9 = cv.z*focal;        m.m13 = -Vector3DotProduct(cv, eye)*focal;
+    m.m2 = cw.x;              m.m6 = cw.y;              m.m10 = cw.z;             m.m14 = -Vector3DotProduct(cw, eye);
+    m.m3 = cw.x;              m.m7 = cw.y;              m.m11 = cw.z;             m.m15 = -Vector3DotProduct(cw, eye);
+    return m;
+}
+
+// Granularité du suivi des modifications : un emplacement vec4 std140
+#define SCENE_SLOT_SIZE 16
+
+SceneBuffer LoadSceneBuffer(void) {
+    SceneBuffer buffer = { 0 };
+    buffer.size = sizeof(SceneBlock);
+    buffer.valid = false;
+
+    glGenBuffers(1, &buffer.id);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer.id);
+    glBufferData(GL_UNIFORM_BUFFER, buffer.size, NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Le point de liaison ne change jamais : il survit aux rechargements du shader
+    glBindBufferBase(GL_UNIFORM_BUFFER, SCENE_BLOCK_BINDING, buffer.id);
+
+    return buffer;
+}
+
+void UnloadSceneBuffer(SceneBuffer *buffer) {
+    if (buffer->id != 0) glDeleteBuffers(1, &buffer->id);
+    buffer->id = 0;
+    buffer->valid = false;
+}
+
+unsigned int UploadSceneBlock(SceneBuffer *buffer, const SceneBlock *block) {
+    const unsigned char *src = (const unsigned char *)block;
+    unsigned char *shadow = (unsigned char *)&buffer->shadow;
+    unsigned int uploaded = 0;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer->id);
+
+    if (!buffer->valid) {
+        // Premier envoi : tout le bloc
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, buffer->size, block);
+        memcpy(shadow, src, buffer->size);
+        uploaded = buffer->size;
+        buffer->valid = true;
+    } else {
+        // Comparaison emplacement par emplacement avec la copie GPU, et envoi
+        // de chaque suite contiguë d'emplacements modifiés en un seul transfert.
+        // La géométrie statique (le sol d'eau 200x200, ...) ne coûte donc plus rien.
+        const unsigned int slotCount = buffer->size / SCENE_SLOT_SIZE;
+        unsigned int slot = 0;
+        while (slot < slotCount) {
+            if (memcmp(src + slot*SCENE_SLOT_SIZE, shadow + slot*SCENE_SLOT_SIZE, SCENE_SLOT_SIZE) == 0) {
+                slot++;
+                continue;
+            }
+            unsigned int first = slot;
+            while (slot < slotCount &&
+                   memcmp(src + slot*SCENE_SLOT_SIZE, shadow + slot*SCENE_SLOT_SIZE, SCENE_SLOT_SIZE) != 0) {
+                slot++;
+            }
+            unsigned int offset = first*SCENE_SLOT_SIZE;
+            unsigned int length = (slot - first)*SCENE_SLOT_SIZE;
+            glBufferSubData(GL_UNIFORM_BUFFER, offset, length, src + offset);
+            memcpy(shadow + offset, src + offset, length);
+            uploaded += length;
+        }
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    buffer->uploadedBytes = uploaded;
+    return uploaded;
+}
@@ -0,0 +1,89 @@
+#ifndef SCENE_UNIFORMS_H
+#define SCENE_UNIFORMS_H
+
+#include "raylib.h"
+#include "scene.h"
+
+// Point de liaison du bloc uniforme SceneBlock
+#define SCENE_BLOCK_BINDING 0
+
+// Emplacements des uniformes "libres" de raytest.fs (hors SceneBlock), résolus
+// une seule fois au chargement du shader (et à chaque rechargement) au lieu de
+// chaque frame. Un emplacement à -1 signifie que l'uniforme n'existe pas (ou a
+// été éliminé par le compilateur GLSL) : SetShaderValue l'ignore alors.
+typedef struct {
+    Shader shader;
+
+    // Caméra et globaux
+    int viewEye;
+    int viewCenter;
+    int resolution;
+    int time;
+    int frameSeed;
+    int frameIndex;
+    int linearOutput;
+
+    // Échantillonnage adaptatif du rendu progressif
+    int adaptiveSampling;
+    int sampleWeights;
+    int sampleBudget;
+
+    // Reprojection vers la frame précédente
+    int previousViewProjection;
+    int previousNormalDepth;
+    int previousRenderScale;
+
+    // Tracé entrelacé
+    int interleaveCount;
+    int interleavePhase;
+
+    // Zone couverte par la texture des vagues
+    int waterFieldRegion;
+
+    // Index du bloc uniforme SceneBlock dans le programme (-1 si absent)
+    int sceneBlockIndex;
+} SceneUniforms;
+
+// Buffer uniforme (UBO) contenant toute la scène (sphères, blocs, matériaux,
+// lumière, faisceau, vagues) au layout std140.
+// Une copie de ce qui se trouve sur le GPU est conservée : seules les plages
+// modifiées depuis le dernier envoi sont retransmises.
+typedef struct {
+    unsigned int id;
+    unsigned int size;
+    SceneBlock shadow;          // Contenu actuel du UBO côté GPU
+    bool valid;                 // false tant que le UBO n'a jamais été rempli
+    unsigned int uploadedBytes; // Octets envoyés lors du dernier UploadSceneBlock
+} SceneBuffer;
+
+// Résolution de tous les emplacements (à appeler après LoadShader et après chaque rechargement)
+void ResolveSceneUniforms(SceneUniforms *su, Shader shader);
+
+// Envoi typé des uniformes libres
+void SetSceneCamera(const SceneUniforms *su, Vector3 eye, Vector3 center);
+void SetSceneResolution(const SceneUniforms *su, float width, float height);
+void SetSceneTime(const SceneUniforms *su, float time);
+void SetSceneFrameSeed(const SceneUniforms *su, float seed);
+void SetSceneFrameIndex(const SceneUniforms *su, int frame);
+void SetSceneLinearOutput(const SceneUniforms *su, bool linear);
+void SetSceneInterleave(const SceneUniforms *su, int count, int phase);
+// Zone (plan xz) couverte par la texture des vagues liée à WATER_FIELD_TEXTURE_UNIT
+void SetSceneWaterField(const SceneUniforms *su, Vector2 origin, float size);
+// Active (weights valide) ou coupe l'échantillonnage adaptatif ; à appeler dans
+// BeginShaderMode, juste avant le draw, comme tout SetShaderValueTexture
+void SetSceneAdaptiveSampling(const SceneUniforms *su, bool enabled, Texture2D weights, float budget);
+// Caméra et G-buffer de la frame précédente (même contrainte que ci-dessus) ;
+// renderScale : part de previousNormalDepth qui était rendue
+void SetSceneReprojection(const SceneUniforms *su, Matrix viewProjection, Texture2D previousNormalDepth, Vector2 renderScale);
+
+// Matrice vue-projection équivalente à la caméra de raytest.fs (setCamera,
+// focale 1.5) : clip.xy/clip.w donne la position dans [-1, 1], clip.w la
+// profondeur linéaire écrite dans le G-buffer
+Matrix GetSceneViewProjection(Vector3 eye, Vector3 center, float aspect);
+
+// Gestion du buffer de scène
+SceneBuffer LoadSceneBuffer(void);
+void UnloadSceneBuffer(SceneBuffer *buffer);
+unsigned int UploadSceneBlock(SceneBuffer *buffer, const SceneBlock *block);   // Envoie les plages modifiées, retourne le nombre d'octets envoyés
+
+#endif // SCENE_UNIFORMS_H
@@ -5,8 +5,10 @@ out vec4 fragColor;
 
 uniform sampler2D currentFrame;  // denoiseTarget
 uniform sampler2D historyFrame;  // renderHistory
+uniform sampler2D reprojection;  // G-buffer : déplacement vers la frame précédente + validité
 
 uniform vec2 resolution;
+uniform vec2 renderScale;   // Part de currentFrame rendue (résolution dynamique), 1 = pleine résolution
 uniform float time;
 uniform int frame;
 
@@ -33,8 +35,16 @@ void main() {
     vec2 uv = fragTexCoord;
     vec2 off = 1.0 / resolution;
 
-    vec3 curr = texture(currentFrame, uv).rgb;
-    vec4 histData = texture(historyFrame, uv);
+    // currentFrame n'occupe que le coin [0, renderScale] : suréchantillonnage
+    // bilinéaire vers la résolution de sortie, voisinage pris dans l'image rendue
+    vec2 uvc = clamp(uv * renderScale, 0.5 * off, renderScale - 0.5 * off);
+
+    vec3 curr = texture(currentFrame, uvc).rgb;
+
+    // Historique au point reprojeté (mouvement de caméra) ; en cas de
+    // désocclusion, il repart de l'image courante
+    vec4 motion = texture(reprojection, uvc);
+    vec4 histData = (motion.z > 0.5) ? texture(historyFrame, uv + motion.xy) : vec4(curr, 1.0);
 
     vec3 hist = histData.rgb;
     float histMixRate = min(histData.a, 0.5); // lire alpha de l’historique
@@ -53,15 +63,15 @@ void main() {
 
     // Neighborhood samples
     vec3 samples[9];
-    samples[0] = texture(currentFrame, uv).rgb;
-    samples[1] = texture(currentFrame, uv + vec2(+off.x, 0.0)).rgb;
-    samples[2] = texture(currentFrame, uv + vec2(-off.x, 0.0)).rgb;
-    samples[3] = texture(currentFrame, uv + vec2(0.0, +off.y)).rgb;
-    samples[4] = texture(currentFrame, uv + vec2(0.0, -off.y)).rgb;
-    samples[5] = texture(currentFrame, uv + vec2(+off.x, +off.y)).rgb;
-    samples[6] = texture(currentFrame, uv + vec2(-off.x, +off.y)).rgb;
-    samples[7] = texture(currentFrame, uv + vec2(+off.x, -off.y)).rgb;
-    samples[8] = texture(currentFrame, uv + vec2(-off.x, -off.y)).rgb;
+    samples[0] = curr;
+    samples[1] = texture(currentFrame, uvc + vec2(+off.x, 0.0)).rgb;
+    samples[2] = texture(currentFrame, uvc + vec2(-off.x, 0.0)).rgb;
+    samples[3] = texture(currentFrame, uvc + vec2(0.0, +off.y)).rgb;
+    samples[4] = texture(currentFrame, uvc + vec2(0.0, -off.y)).rgb;
+    samples[5] = texture(currentFrame, uvc + vec2(+off.x, +off.y)).rgb;
+    samples[6] = texture(currentFrame, uvc + vec2(-off.x, +off.y)).rgb;
+    samples[7] = texture(currentFrame, uvc + vec2(+off.x, -off.y)).rgb;
+    samples[8] = texture(currentFrame, uvc + vec2(-off.x, -off.y)).rgb;
 
     // Convert to YUV for clamping
     vec3 blendedYUV = encodePalYuv(blended);
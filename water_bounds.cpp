@@ -0,0 +1,152 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "water_bounds.h"
+#include "water_field.h"
+#include "raytrace_variants.h"
+#include "scene_uniforms.h"
+#include "rlgl.h"
+
+static void ReleaseWaterBoundsLevels(WaterBounds *bounds) {
+    for (int i = 0; i < bounds->levelCount; i++) rlUnloadFramebuffer(bounds->levels[i].id);
+    if (bounds->texture != 0) glDeleteTextures(1, &bounds->texture);
+    bounds->texture = 0;
+    bounds->levelCount = 0;
+    bounds->size = 0;
+}
+
+// Texture RG32F et ses niveaux jusqu'à 1x1, chacun attaché à son framebuffer
+static void AllocateWaterBoundsLevels(WaterBounds *bounds, int size) {
+    ReleaseWaterBoundsLevels(bounds);
+    bounds->size = size;
+
+    glGenTextures(1, &bounds->texture);
+    glActiveTexture(GL_TEXTURE0 + WATER_BOUNDS_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, bounds->texture);
+    for (int s = size; (s >= 1) && (bounds->levelCount < WATER_BOUNDS_MAX_LEVELS); s /= 2) {
+        glTexImage2D(GL_TEXTURE_2D, bounds->levelCount, GL_RG32F, s, s, 0, GL_RG, GL_FLOAT, NULL);
+        bounds->levelCount++;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, bounds->levelCount - 1);
+    glActiveTexture(GL_TEXTURE0);
+
+    // La texture reste liée à son unité réservée ; chaque niveau a son
+    // framebuffer, décrit comme une render texture à la taille du niveau
+    for (int i = 0; i < bounds->levelCount; i++) {
+        RenderTexture2D *level = &bounds->levels[i];
+        *level = (RenderTexture2D){ 0 };
+        level->id = rlLoadFramebuffer();
+        rlFramebufferAttach(level->id, bounds->texture, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, i);
+        if (!rlFramebufferComplete(level->id)) TraceLog(LOG_WARNING, "WATER: Framebuffer de la pyramide incomplet (niveau %i)", i);
+        level->texture.id = bounds->texture;
+        level->texture.width = size >> i;
+        level->texture.height = size >> i;
+        level->texture.mipmaps = 1;
+    }
+}
+
+void LoadWaterBounds(WaterBounds *bounds, const char *fileName) {
+    *bounds = (WaterBounds){ 0 };
+    bounds->shader = LoadShader(0, fileName);
+    bounds->levelLoc = GetShaderLocation(bounds->shader, "level");
+    BindWaterFieldSampler(bounds->shader);
+    BindWaterBoundsSampler(bounds->shader);
+    AllocateWaterBoundsLevels(bounds, WATER_FIELD_SIZE);
+}
+
+void UnloadWaterBounds(WaterBounds *bounds) {
+    UnloadShader(bounds->shader);
+    ReleaseWaterBoundsLevels(bounds);
+}
+
+void UpdateWaterBounds(WaterBounds *bounds, Texture2D field, bool fieldChanged) {
+    if (field.width != bounds->size) AllocateWaterBoundsLevels(bounds, field.width);
+    else if (!fieldChanged && (field.id == bounds->source)) return;
+    bounds->source = field.id;
+
+    // Bornes écrites telles quelles (ONE, ZERO), sans mélange avec l'alpha
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    for (int i = 0; i < bounds->levelCount; i++) {
+        // Seul le niveau précédent reste lisible pendant l'écriture du niveau i
+        // (le niveau 0 lit le champ : aucun niveau écrit n'est alors lisible)
+        int readable = (i > 0) ? i - 1 : bounds->levelCount - 1;
+        glActiveTexture(GL_TEXTURE0 + WATER_BOUNDS_TEXTURE_UNIT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, readable);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, readable);
+        glActiveTexture(GL_TEXTURE0);
+
+        BeginTextureMode(bounds->levels[i]);
+            BeginBlendMode(BLEND_CUSTOM);
+            BeginShaderMode(bounds->shader);
+                SetShaderValue(bounds->shader, bounds->levelLoc, &i, SHADER_UNIFORM_INT);
+                DrawRectangle(0, 0, bounds->levels[i].texture.width, bounds->levels[i].texture.height, WHITE);
+            EndShaderMode();
+            EndBlendMode();
+        EndTextureMode();
+    }
+
+    // Toute la pyramide redevient lisible pour raytest.fs
+    glActiveTexture(GL_TEXTURE0 + WATER_BOUNDS_TEXTURE_UNIT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, bounds->levelCount - 1);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+int CheckWaterBoundsTraversal(const char *raytraceFileName, Vector2 origin, float size) {
+    Shader shader = LoadShaderWithDefines(raytraceFileName, "#define WATER_TRAVERSAL_CHECK\n");
+    if (!IsShaderValid(shader)) return -1;
+    SceneUniforms uniforms;
+    ResolveSceneUniforms(&uniforms, shader);
+    BindWaterFieldSampler(shader);
+    BindWaterBoundsSampler(shader);
+
+    // Résultats en flottants : échec, impact du parcours, impact de la marche
+    RenderTexture2D target = { 0 };
+    target.id = rlLoadFramebuffer();
+    target.texture.id = rlLoadTexture(NULL, WATER_BOUNDS_CHECK_SIZE, WATER_BOUNDS_CHECK_SIZE, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+    target.texture.width = WATER_BOUNDS_CHECK_SIZE;
+    target.texture.height = WATER_BOUNDS_CHECK_SIZE;
+    target.texture.mipmaps = 1;
+    target.texture.format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32;
+    rlFramebufferAttach(target.id, target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginTextureMode(target);
+        BeginBlendMode(BLEND_CUSTOM);
+        BeginShaderMode(shader);
+            SetSceneResolution(&uniforms, (float)WATER_BOUNDS_CHECK_SIZE, (float)WATER_BOUNDS_CHECK_SIZE);
+            SetSceneWaterField(&uniforms, origin, size);
+            DrawRectangle(0, 0, WATER_BOUNDS_CHECK_SIZE, WATER_BOUNDS_CHECK_SIZE, WHITE);
+        EndShaderMode();
+        EndBlendMode();
+    EndTextureMode();
+
+    const int rayCount = WATER_BOUNDS_CHECK_SIZE*WATER_BOUNDS_CHECK_SIZE;
+    float *results = (float *)MemAlloc(4*rayCount*sizeof(float));
+    glBindTexture(GL_TEXTURE_2D, target.texture.id);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, results);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    int failures = 0, found = 0, marched = 0;
+    for (int i = 0; i < rayCount; i++) {
+        if (results[4*i] > 0.5f) failures++;
+        if (results[4*i + 1] > 0.5f) found++;
+        if (results[4*i + 2] > 0.5f) marched++;
+    }
+    TraceLog((failures == 0) ? LOG_INFO : LOG_WARNING, "WATER: Parcours de la surface : %i/%i rayons rasants en échec (impacts : parcours %i, marche %i)",
+             failures, rayCount, found, marched);
+
+    MemFree(results);
+    UnloadRenderTexture(target);
+    UnloadShader(shader);
+    return failures;
+}
+
+void BindWaterBoundsSampler(Shader shader) {
+    int unit = WATER_BOUNDS_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "waterBounds"), &unit, SHADER_UNIFORM_INT);
+}
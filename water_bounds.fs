@@ -0,0 +1,38 @@
+#version 330
+
+// Pyramide min/max du champ de vagues (water_bounds.h), un niveau par passe.
+// Niveau 0 : bornes de la surface interpolée (filtrage bilinéaire) sur
+// l'empreinte du texel, soit ses 3x3 voisins du champ. Niveaux suivants :
+// min et max des 2x2 cellules du niveau inférieur, seul niveau lisible
+// pendant la passe (GL_TEXTURE_BASE_LEVEL = GL_TEXTURE_MAX_LEVEL).
+// Sortie : hauteur minimale (r) et maximale (g).
+
+uniform sampler2D waterField;   // Hauteur (r) + gradient du champ de la frame
+uniform sampler2D waterBounds;  // Niveau précédent de la pyramide
+uniform int level;              // Niveau écrit par la passe
+
+out vec4 finalColor;
+
+void main() {
+    ivec2 cell = ivec2(gl_FragCoord.xy);
+    vec2 bounds = vec2(1e30, -1e30);
+
+    if (level == 0) {
+        ivec2 last = textureSize(waterField, 0) - 1;
+        for (int j = -1; j <= 1; j++) {
+            for (int i = -1; i <= 1; i++) {
+                float h = texelFetch(waterField, clamp(cell + ivec2(i, j), ivec2(0), last), 0).r;
+                bounds = vec2(min(bounds.x, h), max(bounds.y, h));
+            }
+        }
+    } else {
+        for (int j = 0; j <= 1; j++) {
+            for (int i = 0; i <= 1; i++) {
+                vec2 child = texelFetch(waterBounds, 2*cell + ivec2(i, j), 0).rg;
+                bounds = vec2(min(bounds.x, child.x), max(bounds.y, child.y));
+            }
+        }
+    }
+
+    finalColor = vec4(bounds, 0.0, 1.0);
+}
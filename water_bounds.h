@@ -0,0 +1,44 @@
+#ifndef WATER_BOUNDS_H
+#define WATER_BOUNDS_H
+
+#include "raylib.h"
+
+// Unité de texture réservée à la pyramide (après celles de la passe fusionnée, 12 à 16)
+#define WATER_BOUNDS_TEXTURE_UNIT 17
+
+#define WATER_BOUNDS_MAX_LEVELS 16
+#define WATER_BOUNDS_CHECK_SIZE 64  // Côté de l'image de vérification (un rayon par pixel)
+
+// Pyramide min/max du champ de vagues (RG32F, un niveau de mipmap par niveau
+// du quadtree) : raytest.fs la parcourt pour sauter les zones où le rayon
+// passe au-dessus ou au-dessous de toutes les vagues, et ne cherche
+// l'intersection exacte que dans les texels que la surface peut traverser.
+// Reconstruite (water_bounds.fs) à chaque changement du champ.
+typedef struct {
+    Shader shader;
+    int levelLoc;
+    unsigned int texture;
+    RenderTexture2D levels[WATER_BOUNDS_MAX_LEVELS];    // Un framebuffer par niveau
+    int levelCount;
+    int size;                   // Côté du niveau 0, celui du champ source
+    unsigned int source;        // Texture du champ de la dernière construction
+} WaterBounds;
+
+void LoadWaterBounds(WaterBounds *bounds, const char *fileName);
+void UnloadWaterBounds(WaterBounds *bounds);
+
+// Reconstruit la pyramide du champ donné (texture carrée, côté puissance de
+// deux, liée à WATER_FIELD_TEXTURE_UNIT) s'il a changé depuis la dernière
+// construction ; la pyramide est réallouée quand la taille du champ change
+void UpdateWaterBounds(WaterBounds *bounds, Texture2D field, bool fieldChanged);
+
+// Vérification du parcours de raytest.fs (permutation WATER_TRAVERSAL_CHECK) sur
+// le champ et la pyramide liés, de zone (origin, size) : des rayons rasants
+// sont comparés à une marche régulière. Retourne le nombre de rayons en échec,
+// -1 si la permutation ne compile pas.
+int CheckWaterBoundsTraversal(const char *raytraceFileName, Vector2 origin, float size);
+
+// Liaison du sampler waterBounds d'un shader à son unité de texture
+void BindWaterBoundsSampler(Shader shader);
+
+#endif // WATER_BOUNDS_H
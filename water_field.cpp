@@ -0,0 +1,89 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "water_field.h"
+#include "rlgl.h"
+#include <math.h>
+
+void LoadWaterField(WaterField *field, const char *fileName) {
+    field->shader = LoadShader(0, fileName);
+    ResolveSceneUniforms(&field->uniforms, field->shader);
+
+    // Cible en flottants 32 bits, filtrage bilinéaire : la hauteur sert à
+    // l'intersection, la précision d'un demi-flottant ne suffit pas
+    field->target.id = rlLoadFramebuffer();
+    field->target.texture.id = rlLoadTexture(NULL, WATER_FIELD_SIZE, WATER_FIELD_SIZE, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+    field->target.texture.width = WATER_FIELD_SIZE;
+    field->target.texture.height = WATER_FIELD_SIZE;
+    field->target.texture.mipmaps = 1;
+    field->target.texture.format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32;
+    rlFramebufferAttach(field->target.id, field->target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+    if (!rlFramebufferComplete(field->target.id)) TraceLog(LOG_WARNING, "WATER: Framebuffer incomplet");
+
+    glBindTexture(GL_TEXTURE_2D, field->target.texture.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Champ nul tant que la première évaluation n'a pas eu lieu
+    BeginTextureMode(field->target);
+        ClearBackground(BLANK);
+    EndTextureMode();
+
+    // La texture reste liée à son unité réservée
+    BindWaterFieldTexture(field->target.texture);
+
+    field->origin = (Vector2){ -WATER_FIELD_EXTENT, -WATER_FIELD_EXTENT };
+    field->size = 2.0f*WATER_FIELD_EXTENT;
+    field->time = -1.0f;
+}
+
+void UnloadWaterField(WaterField *field) {
+    UnloadShader(field->shader);
+    UnloadRenderTexture(field->target);
+}
+
+bool UpdateWaterField(WaterField *field, float time, const WaveSource *sources, int count, bool sceneChanged) {
+    if (count == 0) return false;
+    if ((time == field->time) && !sceneChanged) return false;
+    field->time = time;
+
+    // Carré englobant les sources et leur marge
+    Vector2 min = { sources[0].x, sources[0].z };
+    Vector2 max = min;
+    for (int i = 1; i < count; i++) {
+        min.x = fminf(min.x, sources[i].x);
+        min.y = fminf(min.y, sources[i].z);
+        max.x = fmaxf(max.x, sources[i].x);
+        max.y = fmaxf(max.y, sources[i].z);
+    }
+    field->size = fmaxf(max.x - min.x, max.y - min.y) + 2.0f*WATER_FIELD_EXTENT;
+    field->origin = (Vector2){ (min.x + max.x - field->size)*0.5f, (min.y + max.y - field->size)*0.5f };
+
+    // Le champ remplace celui de la frame précédente (ONE, ZERO) : le mélange
+    // alpha par défaut le laisserait dépendre de l'alpha écrit
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginTextureMode(field->target);
+        BeginBlendMode(BLEND_CUSTOM);
+        BeginShaderMode(field->shader);
+            SetSceneTime(&field->uniforms, time);
+            SetSceneResolution(&field->uniforms, (float)WATER_FIELD_SIZE, (float)WATER_FIELD_SIZE);
+            SetSceneWaterField(&field->uniforms, field->origin, field->size);
+            DrawRectangle(0, 0, WATER_FIELD_SIZE, WATER_FIELD_SIZE, WHITE);
+        EndShaderMode();
+        EndBlendMode();
+    EndTextureMode();
+    return true;
+}
+
+void BindWaterFieldTexture(Texture2D texture) {
+    glActiveTexture(GL_TEXTURE0 + WATER_FIELD_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void BindWaterFieldSampler(Shader shader) {
+    int unit = WATER_FIELD_TEXTURE_UNIT;
+    SetShaderValue(shader, GetShaderLocation(shader, "waterField"), &unit, SHADER_UNIFORM_INT);
+}
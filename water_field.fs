@@ -0,0 +1,155 @@
+#version 330
+
+// Pré-passe des vagues : le champ de hauteur, somme des sources vivantes, est
+// évalué une fois par frame sur un carré qui contient chaque source et
+// WATER_FIELD_EXTENT autour d'elle (au-delà, les vagues sont atténuées sous le
+// millième de leur amplitude). raytest.fs
+// intersecte la surface de l'eau avec cette texture au lieu de réévaluer les
+// vagues à chaque pas de l'intersection et pour chaque normale.
+// Sortie : hauteur (r), gradient dh/dx (g) et dh/dz (b), alpha 1.
+
+#define WAVE_SOURCE_MAX 16     // miroir de wave_sources.h
+
+// Paramètres globaux de la scène dans un bloc uniforme std140 (miroir C++ : SceneBlock dans scene.h).
+// L'ordre des champs ne doit pas être modifié sans mettre à jour scene.h et raytest.fs.
+layout(std140) uniform SceneBlock {
+    vec3 lightPos;
+    float lightIntensity;
+    vec3 lightColor;
+    int sphereCount;
+
+    // Faisceau lumineux
+    vec3 beamDirection;
+    float beamAngle;
+    vec3 beamPosition;
+    float beamIntensity;
+    vec3 beamColor;
+    int enableBeam;
+
+    // Vagues circulaires
+    vec3 waveCenter;    // Centre du dernier impact
+    int enableWaves;    // Surface de l'eau déformée (sources vivantes ou simulation)
+    float waveDuration; // Durée des vagues (en secondes)
+    float waveAmplitude; // Amplitude des vagues
+    float waveStartTime; // Moment où les vagues ont commencé
+    float waveDecayRate; // Taux de dissipation par seconde
+    int blockCount;
+    int bvhNodeCount;   // 0 : pas de BVH, parcours linéaire des primitives
+    int lightCount;     // Entrées de lightList (0 : pas d'éclairage direct)
+    float lightTotalPower;
+
+    // Budget de rebonds par type de matériau (indice = type, 4 par ivec4) :
+    // roulette russe à partir de la profondeur minimale, arrêt à la maximale
+    // (0 = MAX_BOUNCES du niveau de qualité)
+    ivec4 materialMinDepth[2];
+    ivec4 materialMaxDepth[2];
+
+    // Sources de vagues vivantes (wave_sources.h), de la plus ancienne à la plus récente
+    int waveSourceCount;
+    vec4 waveSources[WAVE_SOURCE_MAX];  // centre (x, z), début, force (part de waveAmplitude)
+};
+
+uniform float time;         // Temps de la scène
+uniform vec2 resolution;    // Taille de la texture du champ
+uniform vec3 waterFieldRegion;  // Zone couverte : coin (x, z) et côté
+
+out vec4 finalColor;
+
+// Hauteur des vagues circulaires d'une source (centre (x, z), début, force)
+// et ses dérivées partielles analytiques : retourne (h, dh/dx, dh/dz)
+vec3 calculateWaveHeightAndGradient(vec3 pos, vec4 source, float time) {
+    float waveStartTime = source.z;
+    vec2 offset = pos.xz - source.xy;
+    float distance = length(offset);
+    float waveSpeed = 2.0;  // Vitesse de propagation des ondes
+    float waveFreq = 3.0;   // Fréquence des ondulations
+    
+    // Calcul du temps écoulé depuis le début des vagues
+    float elapsedTime = time - waveStartTime;
+    
+    // Atténuation temporelle progressive utilisant le paramètre waveDecayRate
+    float timeAttenuation = 1.0;
+    if (elapsedTime > waveDuration) {
+        // Après la durée active, on laisse les vagues existantes se dissiper naturellement
+        // mais on n'en génère plus de nouvelles
+        
+        // Calculer à quelle distance cette onde a été générée
+        float waveAge = (distance / waveSpeed); // Temps qu'il a fallu à cette onde pour arriver ici
+        float waveGenerationTime = elapsedTime - waveAge; // Moment où cette onde a été générée
+        
+        // Si cette onde a été générée après waveDuration, elle n'existe pas
+        if (waveGenerationTime > waveDuration) {
+            return vec3(0.0); // Pas de nouvelles vagues après le temps imparti
+        }
+        
+        // Sinon, cette onde existe mais se dissipe progressivement
+        float overtimeSeconds = elapsedTime - waveDuration;
+        timeAttenuation = pow(waveDecayRate, overtimeSeconds);
+    } else if (elapsedTime < 0.0) {
+        // Si les vagues n'ont pas encore commencé
+        timeAttenuation = 0.0;
+    } else {
+        // Pendant la durée active, réduction légère pour effet naturel
+        float naturalDecay = mix(0.98, 1.0, waveDecayRate); // Plus le decay est fort, plus la réduction naturelle est faible
+        timeAttenuation = pow(naturalDecay, elapsedTime);
+    }
+    
+    // Atténuation avec la distance (plus progressive)
+    float distanceAttenuation = exp(-distance * 0.15); // Réduit le coefficient pour une portée plus longue
+    
+    // Atténuation supplémentaire pour les vagues très éloignées (après 10 unités)
+    float farDistanceAttenuation = 1.0;
+    float farDistanceRate = 0.0;
+    if (distance > 10.0) {
+        float excessDistance = distance - 10.0;
+        farDistanceAttenuation = exp(-excessDistance * 0.5); // Atténuation rapide au-delà de 10 unités
+        farDistanceRate = 0.5;
+    }
+    
+    // Vérifier si l'onde a eu le temps d'atteindre cette distance
+    float timeToReachDistance = distance / waveSpeed;
+    if (elapsedTime < timeToReachDistance) {
+        return vec3(0.0); // L'onde n'est pas encore arrivée à cette distance
+    }
+    
+    // Atténuation temporelle des ondulations individuelles (vagues vieillissent)
+    float waveAge = elapsedTime - timeToReachDistance; // Temps depuis que l'onde est arrivée ici
+    float ageAttenuation = exp(-waveAge * 0.1); // Les vagues s'affaiblissent en vieillissant
+    
+    // Onde circulaire qui se propage avec toutes les attenuations
+    // Utiliser elapsedTime au lieu de time pour que les vagues partent du centre
+    float phase = waveFreq * distance - waveSpeed * (waveStartTime + elapsedTime);
+    float envelope = distanceAttenuation 
+                   * farDistanceAttenuation
+                   * timeAttenuation 
+                   * ageAttenuation;
+    float wave = sin(phase) * envelope;
+    
+    // Amplitude finale avec réduction progressive globale
+    float finalAmplitude = waveAmplitude * source.w * timeAttenuation;
+    
+    // Dérivée radiale : l'enveloppe ne dépend de la distance que par des
+    // exponentielles (distance, au-delà de 10 unités, âge = t - d/v)
+    float envelopeRate = -0.15 - farDistanceRate + 0.1 / waveSpeed;
+    float dWave = (waveFreq * cos(phase) + envelopeRate * sin(phase)) * envelope;
+    vec2 radial = distance > 1e-5 ? offset / distance : vec2(0.0);
+    
+    return finalAmplitude * vec3(wave, dWave * radial);
+}
+
+// Somme des sources vivantes (les sources éteintes sont retirées sur CPU)
+vec3 waveField(vec3 pos) {
+    vec3 field = vec3(0.0);
+    for (int i = 0; i < waveSourceCount; ++i) {
+        field += calculateWaveHeightAndGradient(pos, waveSources[i], time);
+    }
+    return field;
+}
+
+void main() {
+    vec2 uv = gl_FragCoord.xy / resolution;
+    vec3 pos = vec3(waterFieldRegion.x + uv.x * waterFieldRegion.z, 0.0, waterFieldRegion.y + uv.y * waterFieldRegion.z);
+
+    // Hauteur et gradient analytique en une seule évaluation par source
+    finalColor = vec4(waveField(pos), 1.0);
+}
@@ -0,0 +1,41 @@
+#ifndef WATER_FIELD_H
+#define WATER_FIELD_H
+
+#include "raylib.h"
+#include "scene_uniforms.h"
+#include "wave_sources.h"
+
+// Unité de texture réservée au champ de vagues (raylib n'utilise que 0 à 4)
+#define WATER_FIELD_TEXTURE_UNIT 5
+
+#define WATER_FIELD_SIZE 1024       // Texels par côté (environ 50 par longueur d'onde)
+#define WATER_FIELD_EXTENT 20.0f    // Marge couverte autour de chaque source
+
+// Champ de hauteur des vagues, évalué une fois par frame par une pré-passe
+// (water_field.fs) dans une texture RGBA32F : hauteur + gradient. raytest.fs
+// y lit la surface de l'eau au lieu d'évaluer les vagues analytiquement.
+typedef struct {
+    Shader shader;
+    SceneUniforms uniforms;     // time, resolution et bloc SceneBlock
+    RenderTexture2D target;
+    Vector2 origin;             // Coin (x, z) de la zone couverte
+    float size;                 // Côté de la zone couverte
+    float time;                 // Temps de la dernière évaluation (-1 : jamais)
+} WaterField;
+
+void LoadWaterField(WaterField *field, const char *fileName);
+void UnloadWaterField(WaterField *field);
+
+// Réévalue le champ des sources données pour le temps donné, sur un carré qui
+// les contient toutes. Rien n'est fait sans source vivante (eau immobile), ni
+// si le temps n'a pas changé et que la scène n'a pas été modifiée (rendu progressif).
+// Retourne true si la texture a été réécrite.
+bool UpdateWaterField(WaterField *field, float time, const WaveSource *sources, int count, bool sceneChanged);
+
+// Texture lue par raytest.fs (champ analytique ou simulation CPU)
+void BindWaterFieldTexture(Texture2D texture);
+
+// Liaison du sampler waterField d'un shader à son unité de texture
+void BindWaterFieldSampler(Shader shader);
+
+#endif // WATER_FIELD_H
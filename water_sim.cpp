@@ -0,0 +1,328 @@
+#define GLEW_NO_GLU
+#include "GL/glew.h"
+#include "water_sim.h"
+#include "rlgl.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+// Impact en attente du prochain pas
+typedef struct {
+    float x;
+    float z;
+    float amplitude;
+} WaterImpulse;
+
+struct WaterSimThreads {
+    std::thread coordinator;
+    std::vector<std::thread> workers;
+
+    // Répartition d'un pas : generation change à chaque pas, pending compte
+    // les bandes restantes
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    unsigned int generation;
+    int pending;
+    bool quit;
+
+    // Grille : hauteurs aux pas n - 1, n et n + 1 (permutées après chaque pas)
+    std::vector<float> previous;
+    std::vector<float> current;
+    std::vector<float> next;
+    float damping;              // Facteur appliqué à chaque pas
+
+    // État publié pour le rendu (RGBA par cellule) : staging est écrit par les
+    // workers pendant le pas, puis échangé avec published
+    std::vector<float> staging;
+    std::mutex publishMutex;
+    std::vector<float> published;
+    unsigned int publishedStep;
+
+    std::mutex impulseMutex;
+    std::vector<WaterImpulse> impulses;
+    std::atomic<float> decayRate;
+
+    std::atomic<float> stepMs;
+    std::atomic<unsigned int> stepCount;
+};
+
+static float CellSize(void) {
+    return 2.0f*WATER_SIM_EXTENT/(float)WATER_SIM_SIZE;
+}
+
+// Avance les lignes [rowBegin, rowEnd[ d'un pas et écrit l'état courant
+// (hauteur + gradient) dans staging. Ne lit que previous et current : les
+// bandes sont indépendantes.
+static void StepWaterBand(WaterSimThreads *t, int rowBegin, int rowEnd) {
+    const int n = WATER_SIM_SIZE;
+    const float dt = 1.0f/(float)WATER_SIM_RATE;
+    const float dx = CellSize();
+    const float courant2 = (WATER_SIM_WAVE_SPEED*dt/dx)*(WATER_SIM_WAVE_SPEED*dt/dx);
+    const float *prev = t->previous.data();
+    const float *cur = t->current.data();
+    float *nxt = t->next.data();
+    float *out = t->staging.data();
+
+    for (int j = rowBegin; j < rowEnd; j++) {
+        // Bords réfléchissants : la cellule voisine hors grille est la cellule elle-même
+        int jm = (j > 0) ? j - 1 : j;
+        int jp = (j < n - 1) ? j + 1 : j;
+        for (int i = 0; i < n; i++) {
+            int im = (i > 0) ? i - 1 : i;
+            int ip = (i < n - 1) ? i + 1 : i;
+            float h = cur[j*n + i];
+            float laplacian = cur[j*n + im] + cur[j*n + ip] + cur[jm*n + i] + cur[jp*n + i] - 4.0f*h;
+
+            nxt[j*n + i] = (2.0f*h - prev[j*n + i] + courant2*laplacian)*t->damping;
+
+            float *texel = &out[4*(j*n + i)];
+            texel[0] = h;
+            texel[1] = (cur[j*n + ip] - cur[j*n + im])/((float)(ip - im)*dx);
+            texel[2] = (cur[jp*n + i] - cur[jm*n + i])/((float)(jp - jm)*dx);
+            texel[3] = 0.0f;
+        }
+    }
+}
+
+static void RunWaterWorker(WaterSimThreads *t, int index, int count) {
+    unsigned int seen = 0;
+    int rowBegin = WATER_SIM_SIZE*index/count;
+    int rowEnd = WATER_SIM_SIZE*(index + 1)/count;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(t->mutex);
+            t->workReady.wait(lock, [&]{ return t->quit || (t->generation != seen); });
+            // Un pas déjà lancé est terminé avant de quitter : le coordinateur l'attend
+            if (t->generation == seen) return;
+            seen = t->generation;
+        }
+
+        StepWaterBand(t, rowBegin, rowEnd);
+
+        std::lock_guard<std::mutex> lock(t->mutex);
+        if (--t->pending == 0) t->workDone.notify_one();
+    }
+}
+
+// Impacts en attente : dépression gaussienne appliquée aux pas n - 1 et n (eau
+// déplacée mais immobile), d'où une onde circulaire
+static void ApplyWaterImpulses(WaterSimThreads *t) {
+    std::vector<WaterImpulse> impulses;
+    {
+        std::lock_guard<std::mutex> lock(t->impulseMutex);
+        impulses.swap(t->impulses);
+    }
+
+    const int n = WATER_SIM_SIZE;
+    const float dx = CellSize();
+    const float sigma = WATER_SIM_DROP_RADIUS;
+    const int radius = (int)ceilf(3.0f*sigma/dx);
+    for (const WaterImpulse &impulse : impulses) {
+        int ci = (int)floorf((impulse.x + WATER_SIM_EXTENT)/dx);
+        int cj = (int)floorf((impulse.z + WATER_SIM_EXTENT)/dx);
+        for (int j = cj - radius; j <= cj + radius; j++) {
+            if (j < 0 || j >= n) continue;
+            for (int i = ci - radius; i <= ci + radius; i++) {
+                if (i < 0 || i >= n) continue;
+                float x = -WATER_SIM_EXTENT + ((float)i + 0.5f)*dx - impulse.x;
+                float z = -WATER_SIM_EXTENT + ((float)j + 0.5f)*dx - impulse.z;
+                float drop = impulse.amplitude*expf(-(x*x + z*z)/(sigma*sigma));
+                t->current[j*n + i] -= drop;
+                t->previous[j*n + i] -= drop;
+            }
+        }
+    }
+}
+
+static void RunWaterCoordinator(WaterSimThreads *t) {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0/WATER_SIM_RATE));
+    Clock::time_point deadline = Clock::now();
+
+    while (true) {
+        Clock::time_point start = Clock::now();
+        ApplyWaterImpulses(t);
+        t->damping = powf(t->decayRate.load(), 1.0f/(float)WATER_SIM_RATE);
+
+        // Un pas : toutes les bandes en parallèle
+        {
+            std::unique_lock<std::mutex> lock(t->mutex);
+            if (t->quit) return;
+            t->pending = (int)t->workers.size();
+            t->generation++;
+            t->workReady.notify_all();
+            t->workDone.wait(lock, [&]{ return t->pending == 0; });
+        }
+
+        t->previous.swap(t->current);
+        t->current.swap(t->next);
+        {
+            std::lock_guard<std::mutex> lock(t->publishMutex);
+            t->published.swap(t->staging);
+            t->publishedStep++;
+        }
+
+        float ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+        float average = t->stepMs.load();
+        t->stepMs = (average == 0.0f) ? ms : average*0.95f + ms*0.05f;
+        t->stepCount++;
+
+        // Cadence fixe ; en cas de retard important, on repart de maintenant
+        // plutôt que d'enchaîner les pas pour rattraper
+        deadline += period;
+        Clock::time_point now = Clock::now();
+        if (now > deadline + 4*period) deadline = now;
+        std::this_thread::sleep_until(deadline);
+    }
+}
+
+void LoadWaterSimulation(WaterSimulation *sim) {
+    sim->texture.id = rlLoadTexture(NULL, WATER_SIM_SIZE, WATER_SIM_SIZE, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+    sim->texture.width = WATER_SIM_SIZE;
+    sim->texture.height = WATER_SIM_SIZE;
+    sim->texture.mipmaps = 1;
+    sim->texture.format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32;
+
+    // Bassin au repos, filtrage bilinéaire comme le champ analytique
+    std::vector<float> zero(4*WATER_SIM_SIZE*WATER_SIM_SIZE, 0.0f);
+    glBindTexture(GL_TEXTURE_2D, sim->texture.id);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, WATER_SIM_SIZE, WATER_SIM_SIZE, GL_RGBA, GL_FLOAT, zero.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenBuffers(2, sim->buffers);
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sim->buffers[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, zero.size()*sizeof(float), NULL, GL_STREAM_DRAW);
+        sim->filled[i] = false;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    sim->current = 0;
+    sim->uploadedStep = 0;
+
+    sim->origin = (Vector2){ -WATER_SIM_EXTENT, -WATER_SIM_EXTENT };
+    sim->size = 2.0f*WATER_SIM_EXTENT;
+
+    // Un cœur reste au rendu
+    int cores = (int)std::thread::hardware_concurrency();
+    sim->threadCount = (cores > 1) ? cores - 1 : 1;
+    if (sim->threadCount > WATER_SIM_MAX_THREADS) sim->threadCount = WATER_SIM_MAX_THREADS;
+    sim->threads = NULL;
+    sim->stepMs = 0.0f;
+    sim->stepCount = 0;
+}
+
+void UnloadWaterSimulation(WaterSimulation *sim) {
+    StopWaterSimulation(sim);
+    glDeleteBuffers(2, sim->buffers);
+    rlUnloadTexture(sim->texture.id);
+}
+
+void StartWaterSimulation(WaterSimulation *sim) {
+    if (sim->threads != NULL) return;
+
+    WaterSimThreads *t = new WaterSimThreads();
+    const size_t cells = (size_t)WATER_SIM_SIZE*WATER_SIM_SIZE;
+    t->previous.assign(cells, 0.0f);
+    t->current.assign(cells, 0.0f);
+    t->next.assign(cells, 0.0f);
+    t->staging.assign(4*cells, 0.0f);
+    t->published.assign(4*cells, 0.0f);
+    t->publishedStep = 0;
+    t->generation = 0;
+    t->pending = 0;
+    t->quit = false;
+    t->damping = 1.0f;
+    t->decayRate = 0.9f;
+    t->stepMs = 0.0f;
+    t->stepCount = 0;
+
+    for (int i = 0; i < sim->threadCount; i++) t->workers.push_back(std::thread(RunWaterWorker, t, i, sim->threadCount));
+    t->coordinator = std::thread(RunWaterCoordinator, t);
+
+    sim->threads = t;
+    sim->filled[0] = sim->filled[1] = false;
+    sim->uploadedStep = 0;
+    sim->stepCount = 0;
+}
+
+void StopWaterSimulation(WaterSimulation *sim) {
+    WaterSimThreads *t = sim->threads;
+    if (t == NULL) return;
+
+    {
+        std::lock_guard<std::mutex> lock(t->mutex);
+        t->quit = true;
+    }
+    t->workReady.notify_all();
+    t->coordinator.join();
+    for (std::thread &worker : t->workers) worker.join();
+
+    delete t;
+    sim->threads = NULL;
+}
+
+bool IsWaterSimulationRunning(const WaterSimulation *sim) {
+    return sim->threads != NULL;
+}
+
+void AddWaterImpulse(WaterSimulation *sim, float x, float z, float amplitude) {
+    if (sim->threads == NULL) return;
+    std::lock_guard<std::mutex> lock(sim->threads->impulseMutex);
+    sim->threads->impulses.push_back((WaterImpulse){ x, z, amplitude });
+}
+
+void SetWaterSimulationDecay(WaterSimulation *sim, float decayRate) {
+    if (sim->threads != NULL) sim->threads->decayRate = decayRate;
+}
+
+unsigned int UploadWaterSimulation(WaterSimulation *sim) {
+    WaterSimThreads *t = sim->threads;
+    if (t == NULL) return 0;
+
+    const unsigned int bytes = 4*WATER_SIM_SIZE*WATER_SIM_SIZE*sizeof(float);
+    unsigned int uploaded = 0;
+
+    // 1. Le buffer rempli à la frame précédente est copié dans la texture (le
+    // pilote a eu une frame pour le transférer)
+    if (sim->filled[sim->current]) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sim->buffers[sim->current]);
+        glBindTexture(GL_TEXTURE_2D, sim->texture.id);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, WATER_SIM_SIZE, WATER_SIM_SIZE, GL_RGBA, GL_FLOAT, (void *)0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        sim->filled[sim->current] = false;
+        uploaded = bytes;
+    }
+
+    // 2. Le dernier état publié part dans l'autre buffer, s'il est nouveau
+    int other = 1 - sim->current;
+    {
+        std::lock_guard<std::mutex> lock(t->publishMutex);
+        if (t->publishedStep != sim->uploadedStep) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sim->buffers[other]);
+            void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            if (dst != NULL) {
+                memcpy(dst, t->published.data(), bytes);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                sim->filled[other] = true;
+                sim->uploadedStep = t->publishedStep;
+            }
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    sim->current = other;
+
+    sim->stepMs = t->stepMs.load();
+    sim->stepCount = t->stepCount.load();
+    return uploaded;
+}
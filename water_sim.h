@@ -0,0 +1,59 @@
+#ifndef WATER_SIM_H
+#define WATER_SIM_H
+
+#include "raylib.h"
+
+#define WATER_SIM_SIZE 256              // Cellules par côté de la grille
+#define WATER_SIM_EXTENT 20.0f          // Demi-côté du bassin simulé, centré sur l'origine (plan xz)
+#define WATER_SIM_RATE 120              // Pas de simulation par seconde (temps réel)
+#define WATER_SIM_WAVE_SPEED 2.0f       // Vitesse des ondes (celle du modèle analytique)
+#define WATER_SIM_DROP_RADIUS 0.4f      // Écart-type de la dépression créée par un impact
+#define WATER_SIM_MAX_THREADS 8
+
+// Simulation des vagues sur CPU : équation des ondes (eaux peu profondes
+// linéarisées) par différences finies sur une grille fixe, bords réfléchissants.
+// Contrairement au modèle analytique (une seule source), les impacts
+// s'additionnent et les ondes interfèrent et se réfléchissent.
+//
+// Un thread coordinateur avance la simulation à WATER_SIM_RATE pas par seconde,
+// chaque pas étant réparti par bandes de lignes entre des threads de travail.
+// Le dernier état (hauteur + gradient) est publié pour le thread de rendu, qui
+// l'envoie dans une texture RGBA32F via deux pixel buffers alternés : la copie
+// vers le GPU se fait pendant la frame suivante, sans attente.
+struct WaterSimThreads;
+
+typedef struct {
+    Texture2D texture;              // Hauteur (r), gradient dh/dx (g) et dh/dz (b), comme water_field.h
+    Vector2 origin;                 // Coin (x, z) de la zone couverte
+    float size;                     // Côté de la zone couverte
+
+    unsigned int buffers[2];        // Pixel buffers d'envoi
+    bool filled[2];                 // Buffer rempli, pas encore copié dans la texture
+    int current;                    // Buffer copié dans la texture à la prochaine frame
+    unsigned int uploadedStep;      // Dernier pas envoyé
+
+    struct WaterSimThreads *threads;    // NULL tant que la simulation est arrêtée
+    int threadCount;                // Threads de travail
+    float stepMs;                   // Durée moyenne d'un pas (CPU, tous threads)
+    unsigned int stepCount;         // Pas effectués depuis le démarrage
+} WaterSimulation;
+
+void LoadWaterSimulation(WaterSimulation *sim);
+void UnloadWaterSimulation(WaterSimulation *sim);
+
+// Démarrage (bassin au repos) ou arrêt des threads de simulation
+void StartWaterSimulation(WaterSimulation *sim);
+void StopWaterSimulation(WaterSimulation *sim);
+bool IsWaterSimulationRunning(const WaterSimulation *sim);
+
+// Impact en (x, z) : dépression gaussienne de profondeur amplitude, appliquée au prochain pas
+void AddWaterImpulse(WaterSimulation *sim, float x, float z, float amplitude);
+
+// Part de l'amplitude conservée par seconde (waveDecayRate)
+void SetWaterSimulationDecay(WaterSimulation *sim, float decayRate);
+
+// Envoi du dernier état publié (à appeler une fois par frame), retourne le
+// nombre d'octets copiés vers le GPU
+unsigned int UploadWaterSimulation(WaterSimulation *sim);
+
+#endif // WATER_SIM_H
@@ -0,0 +1,57 @@
+#include "wave_sources.h"
+#include <math.h>
+
+// Paramètres du modèle (water_field.fs)
+#define WAVE_SPEED 2.0f
+#define WAVE_DISTANCE_DECAY 0.15f
+#define WAVE_AGE_DECAY 0.1f
+
+void ClearWaveSources(WaveSourceRing *ring) {
+    ring->first = 0;
+    ring->count = 0;
+}
+
+void AddWaveSource(WaveSourceRing *ring, float x, float z, float startTime, float strength) {
+    WaveSource source = { x, z, startTime, strength };
+    if (ring->count == WAVE_SOURCE_MAX) {
+        ring->sources[ring->first] = source;
+        ring->first = (ring->first + 1) % WAVE_SOURCE_MAX;
+    } else {
+        ring->sources[(ring->first + ring->count) % WAVE_SOURCE_MAX] = source;
+        ring->count++;
+    }
+}
+
+float GetWaveSourceAmplitude(const WaveSource *source, float time, float amplitude, float duration, float decayRate) {
+    float elapsed = time - source->startTime;
+    if (elapsed < 0.0f) return amplitude*source->strength;     // Pas encore commencée
+
+    // Atténuation temporelle (appliquée deux fois dans le shader : onde et amplitude)
+    float timeAttenuation = (elapsed > duration) ? powf(decayRate, elapsed - duration)
+                                                 : powf(0.98f + 0.02f*decayRate, elapsed);
+
+    // Atténuations en distance et en âge au point d = dmin le plus proche du
+    // centre encore parcouru par une onde : exp(-0.15 d) exp(-0.1 (t - d/v))
+    // décroît avec d, et plus aucune onde n'est émise après duration
+    float minDistance = (elapsed > duration) ? WAVE_SPEED*(elapsed - duration) : 0.0f;
+    float spatial = expf(-WAVE_DISTANCE_DECAY*minDistance - WAVE_AGE_DECAY*(elapsed - minDistance/WAVE_SPEED));
+
+    return amplitude*source->strength*timeAttenuation*timeAttenuation*spatial;
+}
+
+void CullWaveSources(WaveSourceRing *ring, float time, float amplitude, float duration, float decayRate) {
+    // Compactage dans l'ordre : l'anneau reste trié de la plus ancienne à la plus récente
+    int kept = 0;
+    for (int k = 0; k < ring->count; k++) {
+        const WaveSource *source = &ring->sources[(ring->first + k) % WAVE_SOURCE_MAX];
+        if (GetWaveSourceAmplitude(source, time, amplitude, duration, decayRate) < WAVE_SOURCE_EPSILON) continue;
+        ring->sources[(ring->first + kept) % WAVE_SOURCE_MAX] = *source;
+        kept++;
+    }
+    ring->count = kept;
+}
+
+int GetWaveSources(const WaveSourceRing *ring, WaveSource *out) {
+    for (int k = 0; k < ring->count; k++) out[k] = ring->sources[(ring->first + k) % WAVE_SOURCE_MAX];
+    return ring->count;
+}
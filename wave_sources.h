@@ -0,0 +1,40 @@
+#ifndef WAVE_SOURCES_H
+#define WAVE_SOURCES_H
+
+#include "raylib.h"
+
+#define WAVE_SOURCE_MAX 16              // Sources simultanées (doit suivre raytest.fs et water_field.fs)
+#define WAVE_SOURCE_EPSILON 1e-3f       // Amplitude en dessous de laquelle une source est retirée
+
+// Source de vagues analytique, 1 vec4 std140 : centre (x, z), début, force
+// (part de waveAmplitude, 1 pour un impact complet)
+typedef struct {
+    float x;
+    float z;
+    float startTime;
+    float strength;
+} WaveSource;
+
+// Anneau des sources actives : un nouvel impact remplace la plus ancienne quand
+// l'anneau est plein. Les sources dont l'amplitude maximale (sur tout le plan)
+// est retombée sous WAVE_SOURCE_EPSILON sont retirées : le shader ne somme que
+// les sources vivantes, et plus rien une fois l'eau immobile.
+typedef struct {
+    WaveSource sources[WAVE_SOURCE_MAX];
+    int first;      // Plus ancienne source
+    int count;
+} WaveSourceRing;
+
+void ClearWaveSources(WaveSourceRing *ring);
+void AddWaveSource(WaveSourceRing *ring, float x, float z, float startTime, float strength);
+
+// Retire les sources éteintes au temps donné (mêmes atténuations que water_field.fs)
+void CullWaveSources(WaveSourceRing *ring, float time, float amplitude, float duration, float decayRate);
+
+// Copie des sources vivantes, de la plus ancienne à la plus récente ; retourne leur nombre
+int GetWaveSources(const WaveSourceRing *ring, WaveSource *out);
+
+// Borne supérieure de l'amplitude d'une source sur tout le plan
+float GetWaveSourceAmplitude(const WaveSource *source, float time, float amplitude, float duration, float decayRate);
+
+#endif // WAVE_SOURCES_H